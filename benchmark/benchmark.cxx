@@ -0,0 +1,95 @@
+// Measures the throughput of vkbase's hot paths.
+//
+// Usage: benchmark [concurrent_cache] [pixel_convert] [streaming_image]
+//
+// Runs every benchmark when none is named. Build in Release; Debug numbers are
+// meaningless.
+
+#include "benchmark.hxx"
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace maseya::vkbase::benchmark;
+
+namespace maseya::vkbase::benchmark {
+std::string format_rate(double count, std::chrono::nanoseconds time) {
+    double rate = count / std::chrono::duration<double>(time).count();
+
+    const char* suffix = "";
+    if (rate >= 1e9) {
+        rate /= 1e9;
+        suffix = " G";
+    } else if (rate >= 1e6) {
+        rate /= 1e6;
+        suffix = " M";
+    } else if (rate >= 1e3) {
+        rate /= 1e3;
+        suffix = " K";
+    } else {
+        suffix = " ";
+    }
+
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(1) << rate << suffix << "/s";
+    return ss.str();
+}
+
+std::string format_frame_time(std::chrono::nanoseconds time, size_t pixel_count) {
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(1)
+       << std::chrono::duration<double, std::micro>(time).count() << " us ("
+       << format_rate(static_cast<double>(pixel_count), time) << ")";
+    return ss.str();
+}
+}  // namespace maseya::vkbase::benchmark
+
+namespace {
+const std::vector<std::pair<std::string, std::function<void()>>> benchmarks = {
+        {"concurrent_cache", run_concurrent_cache_benchmark},
+        {"pixel_convert", run_pixel_convert_benchmark},
+        {"streaming_image", run_streaming_image_benchmark},
+};
+
+int run(int argc, char* argv[]) {
+    std::vector<std::string> names(argv + 1, argv + argc);
+    for (const auto& name : names) {
+        bool found = false;
+        for (const auto& benchmark : benchmarks) {
+            found |= benchmark.first == name;
+        }
+
+        if (!found) {
+            std::cerr << "Unknown benchmark \"" << name << "\".\n";
+            return 2;
+        }
+    }
+
+    for (const auto& [name, benchmark] : benchmarks) {
+        if (names.empty() ||
+            std::find(names.begin(), names.end(), name) != names.end()) {
+            std::cout << "== " << name << " ==\n";
+            benchmark();
+            std::cout << "\n";
+        }
+    }
+
+    return 0;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        return run(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace maseya::vkbase::benchmark {
+struct FrameSize {
+    uint32_t width;
+    uint32_t height;
+};
+
+// The emulator's native and doubled resolutions, and 4K.
+inline constexpr FrameSize frame_sizes[] = {{256, 224}, {512, 448}, {3840, 2160}};
+
+// Runs the function repeatedly for at least min_time, after one untimed warm-up run,
+// and returns the average time of a run.
+template <class Function>
+std::chrono::nanoseconds measure(
+        Function&& function,
+        std::chrono::nanoseconds min_time = std::chrono::milliseconds(250)) {
+    function();
+
+    using clock = std::chrono::steady_clock;
+    size_t run_count = 0;
+    auto start = clock::now();
+    auto elapsed = clock::duration::zero();
+    do {
+        function();
+        run_count++;
+        elapsed = clock::now() - start;
+    } while (elapsed < min_time);
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed) / run_count;
+}
+
+// Formats a count of items processed in the given time as e.g. "123.4 M/s".
+std::string format_rate(double count, std::chrono::nanoseconds time);
+
+// Formats the time taken for a frame as e.g. "12.3 us (45.6 M/s)", with the rate in
+// pixels per second.
+std::string format_frame_time(std::chrono::nanoseconds time, size_t pixel_count);
+
+// Each benchmark prints a table of its results to standard output.
+void run_concurrent_cache_benchmark();
+void run_pixel_convert_benchmark();
+void run_streaming_image_benchmark();
+}  // namespace maseya::vkbase::benchmark
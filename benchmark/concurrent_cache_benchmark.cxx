@@ -0,0 +1,137 @@
+// Compares lookups in ConcurrentCache with a mutex or shared mutex guarded
+// std::unordered_map, with as many threads looking up layouts as worker threads
+// recording command buffers would.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "ConcurrentCache.hxx"
+#include "benchmark.hxx"
+
+namespace maseya::vkbase::benchmark {
+namespace {
+// About as many distinct layouts as a renderer uses.
+constexpr size_t key_count = 256;
+constexpr size_t lookups_per_thread = size_t(1) << 20;
+
+// Lookups follow a fixed random sequence so that every variant does the same work.
+constexpr size_t sequence_size = 4096;
+
+volatile uint64_t lookup_sink;
+
+std::vector<uint64_t> get_keys() {
+    std::mt19937_64 random(12345);
+    std::vector<uint64_t> result(key_count);
+    for (auto& key : result) {
+        key = random();
+    }
+
+    return result;
+}
+
+std::vector<uint64_t> get_sequence(const std::vector<uint64_t>& keys) {
+    std::mt19937_64 random(67890);
+    std::uniform_int_distribution<size_t> distribution(0, keys.size() - 1);
+    std::vector<uint64_t> result(sequence_size);
+    for (auto& key : result) {
+        key = keys[distribution(random)];
+    }
+
+    return result;
+}
+
+// Returns the time for every thread to finish its lookups, including starting the
+// threads.
+template <class Find>
+std::chrono::nanoseconds measure_lookups(unsigned thread_count,
+                                         const std::vector<uint64_t>& sequence,
+                                         const Find& find) {
+    std::atomic<uint64_t> sink(0);
+    auto result = measure([&]() {
+        std::atomic<bool> started(false);
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < thread_count; t++) {
+            threads.emplace_back([&, t]() {
+                while (!started.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+
+                uint64_t sum = 0;
+                size_t offset = t * (sequence_size / 8);
+                for (size_t i = 0; i < lookups_per_thread; i++) {
+                    sum += find(sequence[(offset + i) % sequence_size]);
+                }
+
+                sink.fetch_add(sum, std::memory_order_relaxed);
+            });
+        }
+
+        started.store(true, std::memory_order_release);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    });
+
+    // Keeps the lookups from being optimized away.
+    lookup_sink = sink.load();
+    return result;
+}
+}  // namespace
+
+void run_concurrent_cache_benchmark() {
+    std::vector<uint64_t> keys = get_keys();
+    std::vector<uint64_t> sequence = get_sequence(keys);
+
+    std::unordered_map<uint64_t, uint64_t> map;
+    ConcurrentCache<uint64_t, uint64_t> cache;
+    for (uint64_t key : keys) {
+        map.emplace(key, key >> 1);
+        cache.get_or_create(key, [key]() { return key >> 1; });
+    }
+
+    std::mutex mutex;
+    auto find_locked = [&](uint64_t key) {
+        std::lock_guard lock(mutex);
+        return map.find(key)->second;
+    };
+
+    std::shared_mutex shared_mutex;
+    auto find_shared = [&](uint64_t key) {
+        std::shared_lock lock(shared_mutex);
+        return map.find(key)->second;
+    };
+
+    auto find_cached = [&](uint64_t key) { return *cache.find(key); };
+
+    std::cout << std::left << std::setw(10) << "threads" << std::setw(16) << "mutex"
+              << std::setw(16) << "shared_mutex" << "ConcurrentCache\n";
+
+    unsigned max_thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+    for (unsigned thread_count = 1;; thread_count = std::min(thread_count * 2,
+                                                             max_thread_count)) {
+        double lookup_count = double(lookups_per_thread) * thread_count;
+        std::cout << std::setw(10) << thread_count << std::setw(16)
+                  << format_rate(lookup_count,
+                                 measure_lookups(thread_count, sequence, find_locked))
+                  << std::setw(16)
+                  << format_rate(lookup_count,
+                                 measure_lookups(thread_count, sequence, find_shared))
+                  << format_rate(lookup_count,
+                                 measure_lookups(thread_count, sequence, find_cached))
+                  << "\n";
+
+        if (thread_count == max_thread_count) {
+            break;
+        }
+    }
+}
+}  // namespace maseya::vkbase::benchmark
@@ -0,0 +1,80 @@
+// Times each pixel conversion on a whole frame at the emulator's native and doubled
+// resolutions and at 4K, next to a plain memcpy of the converted frame as the memory
+// bandwidth bound.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "benchmark.hxx"
+#include "pixel_convert.hxx"
+
+namespace maseya::vkbase::benchmark {
+namespace {
+using Convert = void (*)(const void* source, void* destination, size_t count);
+
+struct Conversion {
+    const char* name;
+    Convert convert;
+};
+
+void copy_bgra8(const void* source, void* destination, size_t count) {
+    std::memcpy(destination, source, count * 4);
+}
+
+void convert_bgr555(const void* source, void* destination, size_t count) {
+    convert_bgr555_to_bgra8(static_cast<const uint16_t*>(source), destination, count);
+}
+
+void convert_rgb565(const void* source, void* destination, size_t count) {
+    convert_rgb565_to_bgra8(static_cast<const uint16_t*>(source), destination, count);
+}
+
+const Conversion conversions[] = {
+        {"memcpy", copy_bgra8},
+        {"swizzle_rgba8_bgra8", swizzle_rgba8_bgra8},
+        {"convert_bgr555_to_bgra8", convert_bgr555},
+        {"convert_rgb565_to_bgra8", convert_rgb565},
+        {"premultiply_alpha", premultiply_alpha},
+        {"encode_srgb", encode_srgb},
+        {"decode_srgb", decode_srgb},
+};
+}  // namespace
+
+void run_pixel_convert_benchmark() {
+    std::cout << "Kernels: " << get_pixel_convert_isa() << "\n";
+    std::cout << std::left << std::setw(26) << "conversion";
+    for (const auto& size : frame_sizes) {
+        std::ostringstream ss;
+        ss << size.width << "x" << size.height;
+        std::cout << std::setw(28) << ss.str();
+    }
+    std::cout << "\n";
+
+    for (const auto& conversion : conversions) {
+        std::cout << std::setw(26) << conversion.name;
+        for (const auto& size : frame_sizes) {
+            size_t count = static_cast<size_t>(size.width) * size.height;
+
+            // Large enough for either source pixel size, filled with varied pixels.
+            std::vector<uint8_t> source(count * 4);
+            for (size_t i = 0; i < source.size(); i++) {
+                source[i] = static_cast<uint8_t>(i * 7 + (i >> 8));
+            }
+            std::vector<uint8_t> destination(count * 4);
+
+            auto time = measure([&]() {
+                conversion.convert(source.data(), destination.data(), count);
+            });
+            std::cout << std::setw(28) << format_frame_time(time, count);
+        }
+        std::cout << "\n";
+    }
+}
+}  // namespace maseya::vkbase::benchmark
@@ -0,0 +1,184 @@
+// Times StreamingImage uploads on the first device with a graphics queue, at the
+// emulator's native and doubled resolutions and at 4K.
+//
+// Latency records, submits and waits on one frame at a time. Throughput keeps one
+// frame in flight per staging slice, as a renderer would, and only waits for the frame
+// whose slice is about to be reused. The dirty rectangle row updates a sixth of the
+// frame each time. Rates are pixels uploaded per second.
+
+#include <vulkan/vulkan.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "CommandBuffer.hxx"
+#include "CommandPool.hxx"
+#include "Device.hxx"
+#include "Fence.hxx"
+#include "Instance.hxx"
+#include "StreamingImage.hxx"
+#include "VulkanError.hxx"
+#include "benchmark.hxx"
+#include "vulkan_helper.hxx"
+
+namespace maseya::vkbase::benchmark {
+namespace {
+constexpr VkFormat format = VK_FORMAT_B8G8R8A8_UNORM;
+constexpr uint32_t texel_size = 4;
+constexpr uint32_t frames_in_flight = 2;
+
+struct Frame {
+    Frame(VkDevice device, VkCommandPool command_pool)
+            : command_buffer(device, command_pool),
+              fence(device, VK_FENCE_CREATE_SIGNALED_BIT) {}
+
+    CommandBuffer command_buffer;
+    Fence fence;
+};
+
+struct Context {
+    Context() : instance(), physical_device(VK_NULL_HANDLE), queue_family_index(0) {
+        for (VkPhysicalDevice candidate : get_physical_devices(*instance)) {
+            std::optional<uint32_t> index = get_graphics_queue_family_index(candidate);
+            if (index) {
+                physical_device = candidate;
+                queue_family_index = *index;
+                break;
+            }
+        }
+
+        if (physical_device == VK_NULL_HANDLE) {
+            throw VkBaseError("No physical device has a graphics queue.");
+        }
+    }
+
+    Instance instance;
+    VkPhysicalDevice physical_device;
+    uint32_t queue_family_index;
+};
+
+// Waits until the frame's last submission is done, then records it again and
+// submits it.
+template <class Record>
+void submit_frame(VkDevice device, VkQueue queue, const Frame& frame,
+                  Record&& record) {
+    wait_for_fence(device, *frame.fence);
+    reset_fence(device, *frame.fence);
+
+    frame.command_buffer.begin(true);
+    record(*frame.command_buffer);
+    frame.command_buffer.end();
+
+    VkCommandBuffer command_buffer = *frame.command_buffer;
+    VkSubmitInfo submit_info{};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &command_buffer;
+    assert_result(vkQueueSubmit(queue, 1, &submit_info, *frame.fence));
+}
+
+// Every other tenth of the frame's width, down to a third of its height, as a few
+// moving sprites would dirty it.
+std::vector<VkRect2D> get_dirty_rects(const FrameSize& size) {
+    std::vector<VkRect2D> result;
+    uint32_t width = size.width / 10;
+    for (uint32_t i = 0; i < 10; i += 2) {
+        result.push_back({{static_cast<int32_t>(width * i), 0},
+                          {width, size.height / 3}});
+    }
+    return result;
+}
+
+size_t get_area(const std::vector<VkRect2D>& rects) {
+    size_t result = 0;
+    for (const auto& rect : rects) {
+        result += static_cast<size_t>(rect.extent.width) * rect.extent.height;
+    }
+    return result;
+}
+}  // namespace
+
+void run_streaming_image_benchmark() {
+    Context context;
+    Device device(*context.instance, context.physical_device,
+                  {context.queue_family_index}, format);
+    VkQueue queue = get_queue(*device, context.queue_family_index);
+    CommandPool command_pool(*device, context.queue_family_index);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(context.physical_device, &properties);
+    std::cout << "Device: " << properties.deviceName << "\n";
+
+    std::vector<Frame> frames;
+    for (uint32_t i = 0; i < frames_in_flight; i++) {
+        frames.emplace_back(*device, *command_pool);
+    }
+
+    const char* rows[] = {"latency", "throughput", "dirty rects throughput"};
+    std::vector<std::vector<std::string>> cells(std::size(rows));
+    for (const auto& size : frame_sizes) {
+        size_t count = static_cast<size_t>(size.width) * size.height;
+        size_t source_row_pitch = static_cast<size_t>(size.width) * texel_size;
+        std::vector<uint8_t> pixels(count * texel_size);
+        for (size_t i = 0; i < pixels.size(); i++) {
+            pixels[i] = static_cast<uint8_t>(i * 7 + (i >> 8));
+        }
+
+        StreamingImage image(*device, device.allocator(), format,
+                             {size.width, size.height}, frames_in_flight);
+        auto record_update = [&](VkCommandBuffer command_buffer) {
+            image.update(command_buffer, pixels.data(), source_row_pitch);
+        };
+
+        auto time = measure([&]() {
+            submit_frame(*device, queue, frames.front(), record_update);
+            wait_for_fence(*device, *frames.front().fence);
+        });
+        cells[0].push_back(format_frame_time(time, count));
+
+        size_t frame_index = 0;
+        time = measure([&]() {
+            submit_frame(*device, queue, frames[frame_index], record_update);
+            frame_index = (frame_index + 1) % frames.size();
+        });
+        device.wait_idle();
+        cells[1].push_back(format_frame_time(time, count));
+
+        std::vector<VkRect2D> dirty_rects = get_dirty_rects(size);
+        time = measure([&]() {
+            submit_frame(*device, queue, frames[frame_index],
+                         [&](VkCommandBuffer command_buffer) {
+                             image.update(command_buffer, pixels.data(),
+                                          source_row_pitch, dirty_rects);
+                         });
+            frame_index = (frame_index + 1) % frames.size();
+        });
+        device.wait_idle();
+        cells[2].push_back(format_frame_time(time, get_area(dirty_rects)));
+    }
+
+    std::cout << std::left << std::setw(26) << "update";
+    for (const auto& size : frame_sizes) {
+        std::ostringstream ss;
+        ss << size.width << "x" << size.height;
+        std::cout << std::setw(28) << ss.str();
+    }
+    std::cout << "\n";
+
+    for (size_t i = 0; i < std::size(rows); i++) {
+        std::cout << std::setw(26) << rows[i];
+        for (const auto& cell : cells[i]) {
+            std::cout << std::setw(28) << cell;
+        }
+        std::cout << "\n";
+    }
+}
+}  // namespace maseya::vkbase::benchmark
@@ -0,0 +1,161 @@
+// Compiles a list of shader permutations into a single shader archive.
+//
+// Usage: shader_archiver <job file> <output> [-I <dir>]... [-j <threads>] [-O]
+//
+// Each line of the job file names one archive entry:
+//
+//     <key> <path> [-D <name>[=<value>]]... [-e <entry point>]
+//
+// Blank lines and lines starting with '#' are ignored. Paths are relative to the
+// job file. -O optimizes the SPIR-V for performance and strips debug info.
+
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Compiler.hxx"
+#include "ShaderArchive.hxx"
+#include "SpirvOptimizer.hxx"
+#include "shader_helper.hxx"
+
+namespace fs = std::filesystem;
+using namespace maseya::vkbase;
+
+namespace {
+struct Job {
+    std::string key;
+    ShaderJob shader_job;
+};
+
+Define parse_define(const std::string& text) {
+    size_t separator = text.find('=');
+    if (separator == std::string::npos) {
+        return Define{text, std::string()};
+    }
+
+    return Define{text.substr(0, separator), text.substr(separator + 1)};
+}
+
+std::vector<Job> read_jobs(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw InvalidPathError("Could not open job file.", path);
+    }
+
+    fs::path base_path = fs::path(path).parent_path();
+
+    std::vector<Job> result;
+    std::string line;
+    for (size_t line_number = 1; std::getline(file, line); line_number++) {
+        std::istringstream ss(line);
+        Job job;
+        std::string input_path;
+        if (!(ss >> std::quoted(job.key)) || job.key[0] == '#') {
+            continue;
+        }
+
+        if (!(ss >> std::quoted(input_path))) {
+            std::stringstream message;
+            message << path << "(" << line_number << "): Expected a shader path.";
+            throw VkBaseError(message.str());
+        }
+
+        job.shader_job.input_filename = (base_path / input_path).string();
+        job.shader_job.shader_kind =
+                get_shader_kind_from_file_name(job.shader_job.input_filename);
+
+        std::string option;
+        while (ss >> option) {
+            std::string value;
+            if ((option != "-D" && option != "-e") || !(ss >> std::quoted(value))) {
+                std::stringstream message;
+                message << path << "(" << line_number << "): Unexpected \"" << option
+                        << "\".";
+                throw VkBaseError(message.str());
+            }
+
+            if (option == "-D") {
+                job.shader_job.defines.push_back(parse_define(value));
+            } else {
+                job.shader_job.entrypoint_name = value;
+            }
+        }
+
+        result.push_back(std::move(job));
+    }
+
+    return result;
+}
+
+int run(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: shader_archiver <job file> <output> [-I <dir>]... "
+                     "[-j <threads>] [-O]\n";
+        return 2;
+    }
+
+    Compiler compiler;
+    unsigned thread_count = 0;
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-I" && i + 1 < argc) {
+            compiler.add_include_directory(argv[++i]);
+        } else if (arg == "-j" && i + 1 < argc) {
+            thread_count = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (arg == "-O") {
+            auto optimizer = std::make_shared<SpirvOptimizer>();
+            optimizer->add_recipe(SpirvOptimizationRecipe::Performance)
+                    .add_recipe(SpirvOptimizationRecipe::StripDebugInfo);
+            compiler.set_spirv_optimizer(std::move(optimizer));
+        } else {
+            std::cerr << "Unknown argument \"" << arg << "\".\n";
+            return 2;
+        }
+    }
+
+    std::vector<Job> jobs = read_jobs(argv[1]);
+    std::vector<ShaderJob> shader_jobs;
+    for (const auto& job : jobs) {
+        shader_jobs.push_back(job.shader_job);
+    }
+
+    std::vector<ShaderJobResult> results =
+            compiler.compile_batch(shader_jobs, thread_count);
+
+    ShaderArchiveWriter writer;
+    size_t failed_count = 0;
+    for (size_t i = 0; i < jobs.size(); i++) {
+        if (!results[i].succeeded()) {
+            std::cerr << jobs[i].key << ": " << results[i].error_message << "\n";
+            failed_count++;
+            continue;
+        }
+
+        writer.add(jobs[i].key, std::move(results[i].spirv_code));
+    }
+
+    if (failed_count > 0) {
+        std::cerr << failed_count << " of " << jobs.size()
+                  << " shaders failed to compile.\n";
+        return 1;
+    }
+
+    writer.save(argv[2]);
+    std::cout << "Archived " << writer.size() << " shaders to " << argv[2] << ".\n";
+    return 0;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        return run(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
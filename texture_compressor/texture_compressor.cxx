@@ -0,0 +1,429 @@
+// Compresses an image into a BC1, BC3, BC4 or BC5 DDS file with a full mip chain, to
+// be loaded by CompressedTexture.
+//
+// Usage: texture_compressor <input> <output> [-f bc1|bc3|bc4|bc5] [--srgb] [--no-mips]
+//
+// The format defaults to BC3 for images with alpha and BC1 otherwise. BC4 keeps the
+// red channel and BC5 the red and green channels, e.g. for lookup tables and normal
+// maps. --srgb marks the texture as sRGB encoded and filters mip levels in linear
+// space. BC7 is not encoded; use a dedicated encoder for it.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "VulkanError.hxx"
+#include "stb_image.h"
+
+namespace fs = std::filesystem;
+using namespace maseya::vkbase;
+
+namespace {
+enum class BlockFormat { BC1, BC3, BC4, BC5 };
+
+struct Pixels {
+    uint32_t width;
+    uint32_t height;
+
+    // RGBA8, tightly packed.
+    std::vector<uint8_t> data;
+};
+
+using Block = std::array<std::array<uint8_t, 4>, 16>;
+
+float srgb_to_linear(uint8_t value) {
+    float c = value / 255.0f;
+    return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+uint8_t linear_to_srgb(float value) {
+    float c = value <= 0.0031308f ? value * 12.92f
+                                  : 1.055f * std::pow(value, 1 / 2.4f) - 0.055f;
+    return static_cast<uint8_t>(std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+}
+
+// Halves each dimension with a box filter. Color is averaged in linear space for sRGB
+// textures so that mip levels do not darken.
+Pixels get_next_mip_level(const Pixels& pixels, bool srgb) {
+    Pixels result{std::max(pixels.width / 2, 1u), std::max(pixels.height / 2, 1u), {}};
+    result.data.resize(size_t(result.width) * result.height * 4);
+    for (uint32_t y = 0; y < result.height; y++) {
+        for (uint32_t x = 0; x < result.width; x++) {
+            for (uint32_t c = 0; c < 4; c++) {
+                bool linear = srgb && c < 3;
+                float sum = 0;
+                for (uint32_t dy = 0; dy < 2; dy++) {
+                    for (uint32_t dx = 0; dx < 2; dx++) {
+                        uint32_t sx = std::min(x * 2 + dx, pixels.width - 1);
+                        uint32_t sy = std::min(y * 2 + dy, pixels.height - 1);
+                        size_t index = size_t(sy) * pixels.width + sx;
+                        uint8_t value = pixels.data[index * 4 + c];
+                        sum += linear ? srgb_to_linear(value) : value;
+                    }
+                }
+
+                uint8_t& out = result.data[(size_t(y) * result.width + x) * 4 + c];
+                out = linear ? linear_to_srgb(sum / 4)
+                             : static_cast<uint8_t>(sum / 4 + 0.5f);
+            }
+        }
+    }
+
+    return result;
+}
+
+// Edge blocks of images that are not a multiple of 4 repeat the last row and column.
+Block get_block(const Pixels& pixels, uint32_t block_x, uint32_t block_y) {
+    Block result;
+    for (uint32_t y = 0; y < 4; y++) {
+        for (uint32_t x = 0; x < 4; x++) {
+            uint32_t sx = std::min(block_x * 4 + x, pixels.width - 1);
+            uint32_t sy = std::min(block_y * 4 + y, pixels.height - 1);
+            std::memcpy(result[y * 4 + x].data(),
+                        &pixels.data[(size_t(sy) * pixels.width + sx) * 4], 4);
+        }
+    }
+
+    return result;
+}
+
+uint16_t pack_565(const std::array<int, 3>& color) {
+    return static_cast<uint16_t>((color[0] * 31 + 127) / 255 << 11 |
+                                 (color[1] * 63 + 127) / 255 << 5 |
+                                 (color[2] * 31 + 127) / 255);
+}
+
+std::array<int, 3> unpack_565(uint16_t color) {
+    int r = color >> 11 & 31;
+    int g = color >> 5 & 63;
+    int b = color & 31;
+    return {r << 3 | r >> 2, g << 2 | g >> 4, b << 3 | b >> 2};
+}
+
+void write_16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+// Picks endpoints from the corners of the colors' bounding box, flipped to follow
+// the direction the colors vary in, and inset slightly so that the interpolated
+// colors land inside the box.
+void encode_bc1(const Block& block, uint8_t* out) {
+    std::array<int, 3> min{255, 255, 255};
+    std::array<int, 3> max{0, 0, 0};
+    std::array<int, 3> mean{0, 0, 0};
+    for (const auto& pixel : block) {
+        for (int c = 0; c < 3; c++) {
+            min[c] = std::min(min[c], int(pixel[c]));
+            max[c] = std::max(max[c], int(pixel[c]));
+            mean[c] += pixel[c];
+        }
+    }
+
+    int major = 0;
+    for (int c = 1; c < 3; c++) {
+        if (max[c] - min[c] > max[major] - min[major]) {
+            major = c;
+        }
+    }
+
+    for (int c = 0; c < 3; c++) {
+        if (c == major) {
+            continue;
+        }
+
+        int covariance = 0;
+        for (const auto& pixel : block) {
+            covariance += (pixel[major] * 16 - mean[major]) * (pixel[c] * 16 - mean[c]);
+        }
+
+        if (covariance < 0) {
+            std::swap(min[c], max[c]);
+        }
+    }
+
+    for (int c = 0; c < 3; c++) {
+        int inset = (max[c] - min[c]) / 16;
+        max[c] -= inset;
+        min[c] += inset;
+    }
+
+    uint16_t color0 = pack_565(max);
+    uint16_t color1 = pack_565(min);
+
+    // Four color mode needs color0 > color1. Equal endpoints leave a flat block.
+    if (color0 < color1) {
+        std::swap(color0, color1);
+    }
+
+    write_16(out, color0);
+    write_16(out + 2, color1);
+    std::memset(out + 4, 0, 4);
+    if (color0 == color1) {
+        return;
+    }
+
+    std::array<int, 3> c0 = unpack_565(color0);
+    std::array<int, 3> c1 = unpack_565(color1);
+    std::array<std::array<int, 3>, 4> palette;
+    for (int c = 0; c < 3; c++) {
+        palette[0][c] = c0[c];
+        palette[1][c] = c1[c];
+        palette[2][c] = (2 * c0[c] + c1[c]) / 3;
+        palette[3][c] = (c0[c] + 2 * c1[c]) / 3;
+    }
+
+    for (int i = 0; i < 16; i++) {
+        int best_index = 0;
+        int best_error = INT32_MAX;
+        for (int j = 0; j < 4; j++) {
+            int error = 0;
+            for (int c = 0; c < 3; c++) {
+                int d = block[i][c] - palette[j][c];
+                error += d * d;
+            }
+
+            if (error < best_error) {
+                best_error = error;
+                best_index = j;
+            }
+        }
+
+        out[4 + i / 4] |= static_cast<uint8_t>(best_index << (i % 4 * 2));
+    }
+}
+
+// Uses the eight value mode with the channel's extremes as endpoints.
+void encode_bc4(const Block& block, int channel, uint8_t* out) {
+    int min = 255;
+    int max = 0;
+    for (const auto& pixel : block) {
+        min = std::min(min, int(pixel[channel]));
+        max = std::max(max, int(pixel[channel]));
+    }
+
+    out[0] = static_cast<uint8_t>(max);
+    out[1] = static_cast<uint8_t>(min);
+    std::memset(out + 2, 0, 6);
+    if (max == min) {
+        return;
+    }
+
+    std::array<int, 8> palette{max, min};
+    for (int j = 1; j < 7; j++) {
+        palette[j + 1] = ((7 - j) * max + j * min + 3) / 7;
+    }
+
+    uint64_t indices = 0;
+    for (int i = 0; i < 16; i++) {
+        int best_index = 0;
+        int best_error = INT32_MAX;
+        for (int j = 0; j < 8; j++) {
+            int error = std::abs(block[i][channel] - palette[j]);
+            if (error < best_error) {
+                best_error = error;
+                best_index = j;
+            }
+        }
+
+        indices |= uint64_t(best_index) << (i * 3);
+    }
+
+    for (int i = 0; i < 6; i++) {
+        out[2 + i] = static_cast<uint8_t>(indices >> (i * 8));
+    }
+}
+
+size_t get_block_size(BlockFormat format) {
+    return format == BlockFormat::BC1 || format == BlockFormat::BC4 ? 8 : 16;
+}
+
+std::vector<uint8_t> compress(const Pixels& pixels, BlockFormat format) {
+    uint32_t block_width = (pixels.width + 3) / 4;
+    uint32_t block_height = (pixels.height + 3) / 4;
+    size_t block_size = get_block_size(format);
+
+    std::vector<uint8_t> result(size_t(block_width) * block_height * block_size);
+    uint8_t* out = result.data();
+    for (uint32_t y = 0; y < block_height; y++) {
+        for (uint32_t x = 0; x < block_width; x++, out += block_size) {
+            Block block = get_block(pixels, x, y);
+            switch (format) {
+                case BlockFormat::BC1:
+                    encode_bc1(block, out);
+                    break;
+
+                case BlockFormat::BC3:
+                    encode_bc4(block, 3, out);
+                    encode_bc1(block, out + 8);
+                    break;
+
+                case BlockFormat::BC4:
+                    encode_bc4(block, 0, out);
+                    break;
+
+                case BlockFormat::BC5:
+                    encode_bc4(block, 0, out);
+                    encode_bc4(block, 1, out + 8);
+                    break;
+            }
+        }
+    }
+
+    return result;
+}
+
+uint32_t get_dxgi_format(BlockFormat format, bool srgb) {
+    switch (format) {
+        case BlockFormat::BC1:
+            return srgb ? 72 : 71;
+        case BlockFormat::BC3:
+            return srgb ? 78 : 77;
+        case BlockFormat::BC4:
+            return 80;
+        case BlockFormat::BC5:
+        default:
+            return 83;
+    }
+}
+
+void write_32(std::ofstream& file, uint32_t value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Always writes the DX10 extension header, which is the only way to mark BC1 and BC3
+// as sRGB.
+void write_dds(const std::string& path, const std::vector<std::vector<uint8_t>>& levels,
+               uint32_t width, uint32_t height, uint32_t dxgi_format) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        throw InvalidPathError("Could not open output file.", path);
+    }
+
+    bool has_mips = levels.size() > 1;
+    write_32(file, 0x20534444);  // "DDS "
+    write_32(file, 124);
+    write_32(file, 0x1 | 0x2 | 0x4 | 0x1000 | 0x80000 | (has_mips ? 0x20000 : 0));
+    write_32(file, height);
+    write_32(file, width);
+    write_32(file, static_cast<uint32_t>(levels.front().size()));
+    write_32(file, 0);
+    write_32(file, static_cast<uint32_t>(levels.size()));
+    for (int i = 0; i < 11; i++) {
+        write_32(file, 0);
+    }
+
+    // Pixel format: a FourCC of "DX10".
+    write_32(file, 32);
+    write_32(file, 0x4);
+    write_32(file, 0x30315844);
+    for (int i = 0; i < 5; i++) {
+        write_32(file, 0);
+    }
+
+    write_32(file, 0x1000 | (has_mips ? 0x8 | 0x400000 : 0));
+    for (int i = 0; i < 4; i++) {
+        write_32(file, 0);
+    }
+
+    write_32(file, dxgi_format);
+    write_32(file, 3);  // Texture 2D
+    write_32(file, 0);
+    write_32(file, 1);
+    write_32(file, 0);
+
+    for (const auto& level : levels) {
+        file.write(reinterpret_cast<const char*>(level.data()), level.size());
+    }
+
+    if (!file) {
+        throw InvalidPathError("Could not write output file.", path);
+    }
+}
+
+int run(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: texture_compressor <input> <output> "
+                     "[-f bc1|bc3|bc4|bc5] [--srgb] [--no-mips]\n";
+        return 2;
+    }
+
+    std::string format_name;
+    bool srgb = false;
+    bool mips = true;
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-f" && i + 1 < argc) {
+            format_name = argv[++i];
+        } else if (arg == "--srgb") {
+            srgb = true;
+        } else if (arg == "--no-mips") {
+            mips = false;
+        } else {
+            std::cerr << "Unknown argument \"" << arg << "\".\n";
+            return 2;
+        }
+    }
+
+    int width, height, channels;
+    stbi_uc* data = stbi_load(argv[1], &width, &height, &channels, STBI_rgb_alpha);
+    if (!data) {
+        throw InvalidPathError("Could not load image.", argv[1]);
+    }
+
+    Pixels pixels{static_cast<uint32_t>(width), static_cast<uint32_t>(height),
+                  std::vector<uint8_t>(data, data + size_t(width) * height * 4)};
+    stbi_image_free(data);
+
+    BlockFormat format;
+    if (format_name.empty()) {
+        format = channels == 2 || channels == 4 ? BlockFormat::BC3 : BlockFormat::BC1;
+    } else if (format_name == "bc1") {
+        format = BlockFormat::BC1;
+    } else if (format_name == "bc3") {
+        format = BlockFormat::BC3;
+    } else if (format_name == "bc4") {
+        format = BlockFormat::BC4;
+    } else if (format_name == "bc5") {
+        format = BlockFormat::BC5;
+    } else {
+        std::cerr << "Unknown format \"" << format_name << "\".\n";
+        return 2;
+    }
+
+    std::vector<std::vector<uint8_t>> levels;
+    levels.push_back(compress(pixels, format));
+    while (mips && (pixels.width > 1 || pixels.height > 1)) {
+        pixels = get_next_mip_level(pixels, srgb);
+        levels.push_back(compress(pixels, format));
+    }
+
+    write_dds(argv[2], levels, static_cast<uint32_t>(width),
+              static_cast<uint32_t>(height), get_dxgi_format(format, srgb));
+
+    size_t compressed_size = 0;
+    for (const auto& level : levels) {
+        compressed_size += level.size();
+    }
+
+    std::cout << "Compressed " << argv[1] << " (" << width << "x" << height << ", "
+              << levels.size() << " levels) to " << compressed_size << " bytes.\n";
+    return 0;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        return run(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
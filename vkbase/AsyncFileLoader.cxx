@@ -0,0 +1,153 @@
+#include "AsyncFileLoader.hxx"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "read_file.hxx"
+
+namespace maseya::vkbase {
+namespace {
+AsyncFileLoader::LoadCallback get_promise_callback(
+        std::shared_ptr<std::promise<std::vector<std::byte>>> promise) {
+    return [promise = std::move(promise)](FileLoadResult result) {
+        if (result.error) {
+            promise->set_exception(result.error);
+        } else {
+            promise->set_value(std::move(result.data));
+        }
+    };
+}
+}  // namespace
+
+AsyncFileLoader::AsyncFileLoader(unsigned thread_count)
+        : mutex_(),
+          task_condition_(),
+          idle_condition_(),
+          tasks_(),
+          outstanding_load_count_(0),
+          stop_(false),
+          threads_() {
+    if (thread_count == 0) {
+        thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    for (unsigned i = 0; i < thread_count; i++) {
+        threads_.emplace_back(&AsyncFileLoader::run, this);
+    }
+}
+
+AsyncFileLoader::~AsyncFileLoader() {
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+
+    task_condition_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void AsyncFileLoader::load(std::string path, LoadCallback on_loaded) {
+    std::vector<LoadRequest> requests;
+    requests.push_back({std::move(path), std::move(on_loaded)});
+    submit(std::move(requests));
+}
+
+std::future<std::vector<std::byte>> AsyncFileLoader::load(std::string path) {
+    auto promise = std::make_shared<std::promise<std::vector<std::byte>>>();
+    std::future<std::vector<std::byte>> future = promise->get_future();
+    load(std::move(path), get_promise_callback(std::move(promise)));
+    return future;
+}
+
+void AsyncFileLoader::load_batch(std::vector<std::string> paths,
+                                 LoadCallback on_loaded) {
+    std::vector<LoadRequest> requests;
+    requests.reserve(paths.size());
+    for (auto& path : paths) {
+        requests.push_back({std::move(path), on_loaded});
+    }
+
+    submit(std::move(requests));
+}
+
+std::vector<std::future<std::vector<std::byte>>> AsyncFileLoader::load_batch(
+        std::vector<std::string> paths) {
+    std::vector<LoadRequest> requests;
+    std::vector<std::future<std::vector<std::byte>>> futures;
+    requests.reserve(paths.size());
+    futures.reserve(paths.size());
+    for (auto& path : paths) {
+        auto promise = std::make_shared<std::promise<std::vector<std::byte>>>();
+        futures.push_back(promise->get_future());
+        requests.push_back({std::move(path), get_promise_callback(std::move(promise))});
+    }
+
+    submit(std::move(requests));
+    return futures;
+}
+
+void AsyncFileLoader::wait_idle() {
+    std::unique_lock lock(mutex_);
+    idle_condition_.wait(lock, [this]() { return outstanding_load_count_ == 0; });
+}
+
+void AsyncFileLoader::submit(std::vector<LoadRequest> requests) {
+    if (requests.empty()) {
+        return;
+    }
+
+    {
+        std::lock_guard lock(mutex_);
+        outstanding_load_count_ += requests.size();
+        for (auto& request : requests) {
+            tasks_.push_back([this, request = std::move(request)]() {
+                FileLoadResult result{request.path, {}, nullptr};
+                try {
+                    result.data = read_file<std::byte>(request.path);
+                } catch (...) {
+                    result.error = std::current_exception();
+                }
+
+                complete(std::move(result), request.on_loaded);
+            });
+        }
+    }
+
+    task_condition_.notify_all();
+}
+
+void AsyncFileLoader::complete(FileLoadResult result,
+                               const LoadCallback& on_loaded) noexcept {
+    if (on_loaded) {
+        on_loaded(std::move(result));
+    }
+
+    std::lock_guard lock(mutex_);
+    if (--outstanding_load_count_ == 0) {
+        idle_condition_.notify_all();
+    }
+}
+
+void AsyncFileLoader::run() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(mutex_);
+            task_condition_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+
+            // Queued tasks are drained before stopping so that no load is dropped.
+            if (tasks_.empty()) {
+                return;
+            }
+
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+
+        task();
+    }
+}
+}  // namespace maseya::vkbase
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace maseya::vkbase {
+struct FileLoadResult {
+    std::string path;
+    std::vector<std::byte> data;
+
+    // Null if the file was read.
+    std::exception_ptr error;
+};
+
+// Reads many files at once in the background on a small thread pool, so that asset
+// loads overlap with each other and with whatever decodes them, rather than blocking
+// the render thread one file at a time. TextureStreamer loads images through it, and
+// ShaderProject loads shader sources and include files through it.
+class AsyncFileLoader {
+public:
+    // Called on one of the loader's threads, so it may decode the data in place but
+    // must not throw.
+    using LoadCallback = std::function<void(FileLoadResult result)>;
+
+    // A thread count of zero uses one thread per hardware thread.
+    explicit AsyncFileLoader(unsigned thread_count = 0);
+
+    AsyncFileLoader(const AsyncFileLoader&) = delete;
+    AsyncFileLoader& operator=(const AsyncFileLoader&) = delete;
+
+    // Finishes every load already requested before returning.
+    ~AsyncFileLoader();
+
+    void load(std::string path, LoadCallback on_loaded);
+
+    // The future rethrows the read error, if any.
+    std::future<std::vector<std::byte>> load(std::string path);
+
+    // Requests every file at once, under a single lock.
+    void load_batch(std::vector<std::string> paths, LoadCallback on_loaded);
+    std::vector<std::future<std::vector<std::byte>>> load_batch(
+            std::vector<std::string> paths);
+
+    // Blocks until every requested load has finished and its callback returned.
+    void wait_idle();
+
+private:
+    struct LoadRequest {
+        std::string path;
+        LoadCallback on_loaded;
+    };
+
+private:
+    void submit(std::vector<LoadRequest> requests);
+
+    // Runs the callback and marks the load finished.
+    void complete(FileLoadResult result, const LoadCallback& on_loaded) noexcept;
+
+    void run();
+
+private:
+    std::mutex mutex_;
+    std::condition_variable task_condition_;
+    std::condition_variable idle_condition_;
+    std::deque<std::function<void()>> tasks_;
+    size_t outstanding_load_count_;
+    bool stop_;
+
+    std::vector<std::thread> threads_;
+};
+}  // namespace maseya::vkbase
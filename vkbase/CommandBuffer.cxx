@@ -64,10 +64,15 @@ void CommandBuffer::bind_graphics_pipeline(VkPipeline pipeline) const noexcept {
     vkCmdBindPipeline(*command_buffer_, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
 }
 
-void CommandBuffer::bind_descriptor_set(VkPipelineLayout pipeline_layout,
+void CommandBuffer::bind_compute_pipeline(VkPipeline pipeline) const noexcept {
+    vkCmdBindPipeline(*command_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+}
+
+void CommandBuffer::bind_descriptor_set(VkPipelineBindPoint bind_point,
+                                        VkPipelineLayout pipeline_layout,
                                         VkDescriptorSet descriptor_set) const noexcept {
-    vkCmdBindDescriptorSets(*command_buffer_, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                            pipeline_layout, 0, 1, &descriptor_set, 0, nullptr);
+    vkCmdBindDescriptorSets(*command_buffer_, bind_point, pipeline_layout, 0, 1,
+                            &descriptor_set, 0, nullptr);
 }
 
 void CommandBuffer::draw(uint32_t vertex_count, uint32_t instance_count,
@@ -80,5 +85,36 @@ void CommandBuffer::end_render_pass() const noexcept {
     vkCmdEndRenderPass(*command_buffer_);
 }
 
+void CommandBuffer::dispatch(uint32_t group_count_x, uint32_t group_count_y,
+                             uint32_t group_count_z) const noexcept {
+    vkCmdDispatch(*command_buffer_, group_count_x, group_count_y, group_count_z);
+}
+
+void CommandBuffer::dispatch_indirect(VkBuffer buffer,
+                                      VkDeviceSize offset) const noexcept {
+    vkCmdDispatchIndirect(*command_buffer_, buffer, offset);
+}
+
+void CommandBuffer::transition_layout(VkImage image, VkImageLayout old_layout,
+                                      VkImageLayout new_layout) const {
+    vkbase::transition_layout(*command_buffer_, image, old_layout, new_layout);
+}
+
+void CommandBuffer::memory_barrier(VkPipelineStageFlags source_stage,
+                                   VkAccessFlags source_access,
+                                   VkPipelineStageFlags destination_stage,
+                                   VkAccessFlags destination_access) const noexcept {
+    vkbase::memory_barrier(*command_buffer_, source_stage, source_access,
+                           destination_stage, destination_access);
+}
+
+void CommandBuffer::buffer_barrier(VkBuffer buffer, VkPipelineStageFlags source_stage,
+                                   VkAccessFlags source_access,
+                                   VkPipelineStageFlags destination_stage,
+                                   VkAccessFlags destination_access) const noexcept {
+    buffer_memory_barrier(*command_buffer_, buffer, source_stage, source_access,
+                          destination_stage, destination_access);
+}
+
 void CommandBuffer::end() const { end_command(*command_buffer_); }
 }  // namespace maseya::vkbase
\ No newline at end of file
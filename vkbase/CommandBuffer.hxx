@@ -50,9 +50,24 @@ public:
 
     void bind_graphics_pipeline(VkPipeline pipeline) const noexcept;
 
-    void bind_descriptor_set(VkPipelineLayout pipeline_layout,
+    void bind_compute_pipeline(VkPipeline pipeline) const noexcept;
+
+    void bind_descriptor_set(VkPipelineBindPoint bind_point,
+                             VkPipelineLayout pipeline_layout,
                              VkDescriptorSet descriptor_set) const noexcept;
 
+    void bind_descriptor_set(VkPipelineLayout pipeline_layout,
+                             VkDescriptorSet descriptor_set) const noexcept {
+        bind_descriptor_set(VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout,
+                            descriptor_set);
+    }
+
+    void bind_compute_descriptor_set(VkPipelineLayout pipeline_layout,
+                                     VkDescriptorSet descriptor_set) const noexcept {
+        bind_descriptor_set(VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_layout,
+                            descriptor_set);
+    }
+
     void draw_quads(uint32_t instance_count, uint32_t start_index = 0) const noexcept {
         draw(4, instance_count, 0, start_index);
     }
@@ -62,6 +77,40 @@ public:
 
     void end_render_pass() const noexcept;
 
+    void dispatch(uint32_t group_count_x, uint32_t group_count_y = 1,
+                  uint32_t group_count_z = 1) const noexcept;
+
+    // The buffer must contain a VkDispatchIndirectCommand at the given offset and be
+    // created with VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT.
+    void dispatch_indirect(VkBuffer buffer, VkDeviceSize offset = 0) const noexcept;
+
+    void transition_layout(VkImage image, VkImageLayout old_layout,
+                           VkImageLayout new_layout) const;
+
+    void memory_barrier(VkPipelineStageFlags source_stage, VkAccessFlags source_access,
+                        VkPipelineStageFlags destination_stage,
+                        VkAccessFlags destination_access) const noexcept;
+
+    void buffer_barrier(VkBuffer buffer, VkPipelineStageFlags source_stage,
+                        VkAccessFlags source_access,
+                        VkPipelineStageFlags destination_stage,
+                        VkAccessFlags destination_access) const noexcept;
+
+    // Makes compute shader writes visible to a later compute dispatch.
+    void compute_to_compute_barrier() const noexcept {
+        memory_barrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+    }
+
+    // Makes compute shader writes visible to vertex input and fragment shader reads of
+    // a later draw.
+    void compute_to_graphics_barrier() const noexcept {
+        memory_barrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                       VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+                               VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                       VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_SHADER_READ_BIT);
+    }
+
     void end() const;
 
 private:
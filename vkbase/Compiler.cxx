@@ -1,15 +1,59 @@
 #include "Compiler.hxx"
 
 #include <algorithm>
+#include <atomic>
+#include <cctype>
 #include <filesystem>
 #include <sstream>
+#include <thread>
+#include <utility>
 
+#include "SpirvCache.hxx"
+#include "SpirvOptimizer.hxx"
 #include "VulkanError.hxx"
+#include "math_helper.hxx"
 #include "read_file.hxx"
 
 namespace maseya::vkbase {
 namespace fs = std::filesystem;
 
+namespace {
+// shaderc resolves includes synchronously on the compiling thread, so the includes of
+// the current compilation can be collected through a thread local.
+thread_local std::vector<ShaderDependency>* recorded_dependencies = nullptr;
+
+class DependencyRecorder {
+public:
+    DependencyRecorder()
+            : dependencies_(),
+              previous_(std::exchange(recorded_dependencies, &dependencies_)) {}
+
+    DependencyRecorder(const DependencyRecorder&) = delete;
+    DependencyRecorder& operator=(const DependencyRecorder&) = delete;
+
+    ~DependencyRecorder() { recorded_dependencies = previous_; }
+
+    const std::vector<ShaderDependency>& dependencies() const noexcept {
+        return dependencies_;
+    }
+
+private:
+    std::vector<ShaderDependency> dependencies_;
+    std::vector<ShaderDependency>* previous_;
+};
+
+// Windows paths are not case sensitive, so the index is keyed by lower case names
+// there, and an #include <Foo.h> finds foo.h as the filesystem would.
+std::string get_index_key(std::string name) {
+#ifdef _WIN32
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+#endif
+    return name;
+}
+}  // namespace
+
 ShaderCCompileError::ShaderCCompileError(ShaderCompilationStatus status)
         : ShaderCCompileError(status, get_error_message(status)) {}
 ShaderCCompileError::ShaderCCompileError(ShaderCompilationStatus status,
@@ -19,15 +63,9 @@ ShaderCCompileError::ShaderCCompileError(ShaderCompilationStatus status,
                                          const std::string& message)
         : ShaderCCompileError(status, message.c_str()) {}
 
-IncludeResult::IncludeResult(const std::string& source_name,
-                             const std::string&& content)
-        : source_name_(source_name), content_(std::move(content)), include_result_{} {
-    include_result_.source_name = source_name.empty() ? nullptr : source_name.c_str();
-    include_result_.source_name_length = source_name.size();
-    include_result_.content = content.empty() ? nullptr : content.c_str();
-    include_result_.content_length = content.size();
-    include_result_.user_data = reinterpret_cast<void*>(this);
-}
+IncludeResult::IncludeResult(const std::string& source_name, std::string&& content)
+        : IncludeResult(source_name,
+                        std::make_shared<const std::string>(std::move(content))) {}
 
 IncludeResult::IncludeResult(const std::string& source_name, const std::string& content)
         : IncludeResult(source_name, std::string(content)) {}
@@ -35,21 +73,115 @@ IncludeResult::IncludeResult(const std::string& source_name, const std::string&
 IncludeResult::IncludeResult(const std::string& source_name)
         : IncludeResult(source_name, read_file(source_name)) {}
 
+IncludeResult::IncludeResult(const std::string& source_name,
+                             std::shared_ptr<const std::string> content)
+        : source_name_(source_name), content_(std::move(content)), include_result_{} {
+    update_include_result();
+}
+
 IncludeResult::IncludeResult(const IncludeResult& rhs)
         : IncludeResult(rhs.source_name_, rhs.content_) {}
 
+IncludeResult::IncludeResult(IncludeResult&& rhs) noexcept
+        : source_name_(std::move(rhs.source_name_)),
+          content_(rhs.content_),
+          include_result_{} {
+    update_include_result();
+    rhs.update_include_result();
+}
+
 IncludeResult& IncludeResult::operator=(const IncludeResult& rhs) {
-    return *this = IncludeResult(rhs.source_name_, rhs.content_);
+    source_name_ = rhs.source_name_;
+    content_ = rhs.content_;
+    update_include_result();
+    return *this;
+}
+
+IncludeResult& IncludeResult::operator=(IncludeResult&& rhs) noexcept {
+    std::swap(source_name_, rhs.source_name_);
+    std::swap(content_, rhs.content_);
+    update_include_result();
+    rhs.update_include_result();
+    return *this;
 }
 
 IncludeResult IncludeResult::make_error(const std::string& error) {
     return IncludeResult(std::string(), error);
 }
 
+void IncludeResult::update_include_result() noexcept {
+    // The pointers must follow the strings this object owns, and the user data must
+    // follow the object itself, so they are refreshed whenever either changes.
+    include_result_.source_name = source_name_.empty() ? nullptr : source_name_.c_str();
+    include_result_.source_name_length = source_name_.size();
+    include_result_.content = content_->empty() ? nullptr : content_->c_str();
+    include_result_.content_length = content_->size();
+    include_result_.user_data = reinterpret_cast<void*>(this);
+}
+
 IncludeResolver::IncludeResolver() : IncludeResolver(1000) {}
 
 IncludeResolver::IncludeResolver(std::size_t max_include_depth)
-        : max_include_depth_(max_include_depth), standard_include_paths_() {}
+        : IncludeResolver(max_include_depth, IncludeCache::get_shared()) {}
+
+IncludeResolver::IncludeResolver(std::size_t max_include_depth,
+                                 std::shared_ptr<IncludeCache> include_cache)
+        : max_include_depth_(max_include_depth),
+          standard_include_paths_(),
+          include_cache_(std::move(include_cache)),
+          index_mutex_(),
+          standard_include_index_(),
+          index_version_(0) {}
+
+IncludeResolver::IncludeResolver(const IncludeResolver& rhs)
+        : max_include_depth_(rhs.max_include_depth_),
+          standard_include_paths_(),
+          include_cache_(rhs.include_cache_),
+          index_mutex_(),
+          standard_include_index_(),
+          index_version_(0) {
+    std::lock_guard lock(rhs.index_mutex_);
+    standard_include_paths_ = rhs.standard_include_paths_;
+    standard_include_index_ = rhs.standard_include_index_;
+    index_version_ = rhs.index_version_.load();
+}
+
+void IncludeResolver::add_standard_include_path(const std::string& path) {
+    std::string dir = fs::absolute(path).lexically_normal().string();
+    if (!fs::is_directory(dir)) {
+        throw InvalidPathError("Include directory does not exist.", dir);
+    }
+
+    std::lock_guard lock(index_mutex_);
+    standard_include_paths_.push_back(dir);
+    index_standard_include_path(dir);
+    index_version_++;
+}
+
+void IncludeResolver::rescan_standard_include_paths() {
+    std::lock_guard lock(index_mutex_);
+    standard_include_index_.clear();
+    for (const auto& dir : standard_include_paths_) {
+        index_standard_include_path(dir);
+    }
+    index_version_++;
+}
+
+void IncludeResolver::index_standard_include_path(const std::string& path) {
+    std::error_code ec;
+    fs::recursive_directory_iterator it(
+            path, fs::directory_options::skip_permission_denied, ec);
+    for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (!it->is_regular_file(ec)) {
+            continue;
+        }
+
+        // Earlier directories take precedence, so existing names are kept.
+        standard_include_index_.emplace(
+                get_index_key(it->path().lexically_relative(path).generic_string()),
+                it->path().lexically_normal().string());
+    }
+}
 
 IncludeResult* IncludeResolver::resolve_include(const std::string& requested_source,
                                                 ShaderIncludeType shader_include_type,
@@ -61,31 +193,66 @@ IncludeResult* IncludeResolver::resolve_include(const std::string& requested_sou
         return new IncludeResult(IncludeResult::make_error(ss.str()));
     }
 
-    fs::path source_path;
+    IncludeFile include_file{};
     if (shader_include_type == ShaderIncludeType::Standard) {
-        auto source_path_it = std::find_if(
-                standard_include_paths_.begin(), standard_include_paths_.end(),
-                [&source_path, &requested_source](const std::string& dir) {
-                    source_path = fs::path(dir) / requested_source;
-                    return fs::exists(source_path);
-                });
-        if (source_path_it == standard_include_paths_.end()) {
+        include_file = find_standard_include(requested_source);
+        if (!include_file.content) {
             std::stringstream ss;
-            ss << "Could not find include file: <" << requesting_source << ">.";
+            ss << "Could not find include file: <" << requested_source << ">.";
             return new IncludeResult(IncludeResult::make_error(ss.str()));
         }
     } else {
         fs::path input_path(requesting_source);
-        source_path = input_path.parent_path() / requested_source;
-        if (!fs::exists(source_path)) {
+        fs::path source_path = input_path.parent_path() / requested_source;
+        include_file = include_cache_->get(source_path.string());
+        if (!include_file.content) {
+            if (recorded_dependencies) {
+                recorded_dependencies->push_back({include_file.path, 0, true});
+            }
+
             std::stringstream ss;
-            ss << "Could not find include file: \""
-               << fs::absolute(source_path).string() << "\".";
+            ss << "Could not find include file: \"" << include_file.path << "\".";
             return new IncludeResult(IncludeResult::make_error(ss.str()));
         }
     }
 
-    return new IncludeResult(source_path.string());
+    if (recorded_dependencies) {
+        recorded_dependencies->push_back(
+                {include_file.path, include_file.content_hash});
+    }
+
+    return new IncludeResult(include_file.path, std::move(include_file.content));
+}
+
+IncludeFile IncludeResolver::find_standard_include(
+        const std::string& requested_source) const {
+    std::string name = fs::path(requested_source).lexically_normal().generic_string();
+
+    std::string path;
+    std::vector<std::string> dirs;
+    {
+        std::lock_guard lock(index_mutex_);
+        auto it = standard_include_index_.find(get_index_key(name));
+        if (it != standard_include_index_.end()) {
+            path = it->second;
+        } else {
+            dirs = standard_include_paths_;
+        }
+    }
+
+    if (!path.empty()) {
+        return include_cache_->get(path);
+    }
+
+    // The file may have been added since the directories were scanned.
+    for (const auto& dir : dirs) {
+        IncludeFile include_file = include_cache_->get((fs::path(dir) / name).string());
+        if (include_file.content) {
+            return include_file;
+        }
+    }
+
+    return IncludeFile{};
 }
 
 void IncludeResolver::release_include_result(IncludeResult* include_result) const {
@@ -116,11 +283,12 @@ void CompileOptions::Destroyer::operator()(
 
 CompileOptions::CompileOptions()
         : compile_options_(shaderc_compile_options_initialize()),
-          include_resolver_(1000) {
+          include_resolver_(std::make_unique<IncludeResolver>(1000)),
+          state_key_() {
     assert_exists();
     shaderc_compile_options_set_include_callbacks(
             *compile_options_, IncludeResolver::include_resolve_fn,
-            IncludeResolver::include_result_release_fn, &include_resolver_);
+            IncludeResolver::include_result_release_fn, include_resolver_.get());
 }
 
 CompileOptions::CompileOptions(ShaderSourceLanguage source_langaue) : CompileOptions() {
@@ -141,10 +309,15 @@ CompileOptions::CompileOptions(ShaderSourceLanguage source_langaue,
 }
 
 CompileOptions::CompileOptions(const CompileOptions& rhs)
-        : compile_options_(shaderc_compile_options_clone(*rhs.compile_options_)) {
+        : compile_options_(shaderc_compile_options_clone(*rhs.compile_options_)),
+          include_resolver_(std::make_unique<IncludeResolver>(*rhs.include_resolver_)),
+          state_key_(rhs.state_key_) {
     assert_exists();
 
-    // TODO(nrg): Do I need to add include function resolver here?
+    // Cloning does not carry over the include callbacks.
+    shaderc_compile_options_set_include_callbacks(
+            *compile_options_, IncludeResolver::include_resolve_fn,
+            IncludeResolver::include_result_release_fn, include_resolver_.get());
 }
 
 CompileOptions& CompileOptions::operator=(const CompileOptions& rhs) {
@@ -152,30 +325,57 @@ CompileOptions& CompileOptions::operator=(const CompileOptions& rhs) {
     return *this = std::move(result);
 }
 
-void CompileOptions::set_source_language(ShaderSourceLanguage source_language) const {
+void CompileOptions::set_source_language(ShaderSourceLanguage source_language) {
     shaderc_compile_options_set_source_language(
             *compile_options_, static_cast<shaderc_source_language>(source_language));
+
+    std::stringstream ss;
+    ss << "language=" << static_cast<int>(source_language) << ';';
+    state_key_ += ss.str();
 }
 
 void CompileOptions::set_optimization_level(
-        ShaderOptimizationLevel optimization_level) const {
+        ShaderOptimizationLevel optimization_level) {
     shaderc_compile_options_set_optimization_level(
             *compile_options_,
             static_cast<shaderc_optimization_level>(optimization_level));
+
+    std::stringstream ss;
+    ss << "optimization=" << static_cast<int>(optimization_level) << ';';
+    state_key_ += ss.str();
 }
 
 void CompileOptions::set_target_env(ShaderTargetEnv target_env,
-                                    ShaderEnvVersion env_version) const {
+                                    ShaderEnvVersion env_version) {
     shaderc_compile_options_set_target_env(
             *compile_options_, static_cast<shaderc_target_env>(target_env),
             static_cast<shaderc_env_version>(env_version));
+
+    std::stringstream ss;
+    ss << "target=" << static_cast<int>(target_env) << ','
+       << static_cast<int>(env_version) << ';';
+    state_key_ += ss.str();
 }
 
-void CompileOptions::add_macro_definition(const Define& define) const {
+void CompileOptions::add_macro_definition(const Define& define) {
     shaderc_compile_options_add_macro_definition(
             *compile_options_, define.name.empty() ? nullptr : define.name.c_str(),
             define.name.size(), define.value.empty() ? nullptr : define.value.c_str(),
             define.value.size());
+
+    state_key_ += "define=";
+    state_key_ += define.name;
+    state_key_ += '\0';
+    state_key_ += define.value;
+    state_key_ += ';';
+}
+
+void CompileOptions::add_include_directory(const std::string& path) {
+    include_resolver_->add_standard_include_path(path);
+
+    state_key_ += "include_directory=";
+    state_key_ += path;
+    state_key_ += ';';
 }
 
 void CompileOptions::assert_exists() const {
@@ -194,7 +394,11 @@ Compiler::Compiler()
         : compiler_(shaderc_compiler_initialize()),
           compile_options_(ShaderSourceLanguage::Glsl,
                            ShaderOptimizationLevel::Performance,
-                           ShaderTargetEnv::Vulkan, ShaderEnvVersion::Vulkan_1_0) {
+                           ShaderTargetEnv::Vulkan, ShaderEnvVersion::Vulkan_1_0),
+          define_options_(
+                  std::make_unique<ConcurrentCache<std::string, CompileOptions>>()),
+          spirv_cache_(),
+          spirv_optimizer_() {
     if (!compiler_) {
         throw VkBaseError(
                 "Could not initialize shaderc compiler. An unknown error occurred.");
@@ -223,15 +427,30 @@ std::vector<uint32_t> Compiler::compile_shader(
 std::vector<uint32_t> Compiler::compile_shader(
         const std::string& source, const std::string& input_filename,
         ShaderKind shader_kind, const std::string& entrypoint_name,
-        const std::vector<Define>& defines) const {
-    CompileOptions options = compile_options_;
-    options.add_macro_definitions(defines.begin(), defines.end());
+        const std::vector<Define>& defines,
+        std::vector<ShaderDependency>* dependencies) const {
+    std::uint64_t cache_key = 0;
+    if (spirv_cache_) {
+        cache_key = get_spirv_cache_key(source, input_filename, shader_kind,
+                                        entrypoint_name, defines);
+        if (auto spirv_code =
+                    spirv_cache_->find(cache_key, *include_cache(), dependencies)) {
+            return std::move(*spirv_code);
+        }
+    }
+
+    DependencyRecorder dependency_recorder;
 
     CompilationResult compilation_result(*this, source, input_filename, shader_kind,
-                                         entrypoint_name, options);
+                                         entrypoint_name,
+                                         get_compile_options(defines));
 
     ShaderCompilationStatus status = compilation_result.status();
     if (status != ShaderCompilationStatus::Success) {
+        if (dependencies) {
+            *dependencies = dependency_recorder.dependencies();
+        }
+
         throw ShaderCCompileError(status, compilation_result.error_message());
     }
 
@@ -240,7 +459,114 @@ std::vector<uint32_t> Compiler::compile_shader(
         warnings = compilation_result.error_message();
     }
 
-    return compilation_result.spirv_code();
+    std::vector<uint32_t> spirv_code = compilation_result.spirv_code();
+    if (spirv_optimizer_) {
+        spirv_code = spirv_optimizer_->optimize(spirv_code, input_filename);
+    }
+    if (spirv_cache_) {
+        spirv_cache_->store(cache_key, dependency_recorder.dependencies(), spirv_code);
+    }
+
+    if (dependencies) {
+        *dependencies = dependency_recorder.dependencies();
+    }
+
+    return spirv_code;
+}
+
+std::vector<ShaderJobResult> Compiler::compile_batch(const ShaderJob* jobs,
+                                                     size_t count,
+                                                     unsigned thread_count) const {
+    std::vector<ShaderJobResult> results(count);
+
+    // Nothing here is copied per job: jobs with the same defines share one set of
+    // options from define_options_, along with its include resolver. This relies on
+    // shaderc allowing a compiler and its options to be used from several threads at
+    // once as long as neither is modified. The resolver's lookups lock, and it records
+    // dependencies per thread.
+    std::atomic<size_t> next_job_index(0);
+    auto run = [this, jobs, count, &results, &next_job_index]() {
+        for (size_t i = next_job_index++; i < count; i = next_job_index++) {
+            const ShaderJob& job = jobs[i];
+            ShaderJobResult& result = results[i];
+            try {
+                result.spirv_code = compile_shader(
+                        job.source ? *job.source : read_file(job.input_filename),
+                        job.input_filename, job.shader_kind, job.entrypoint_name,
+                        job.defines, &result.dependencies);
+                result.status = ShaderCompilationStatus::Success;
+            } catch (const ShaderCCompileError& e) {
+                result.status = e.status();
+                result.error_message = e.what();
+            } catch (const std::exception& e) {
+                result.status = ShaderCompilationStatus::InternalError;
+                result.error_message = e.what();
+            }
+        }
+    };
+
+    if (thread_count == 0) {
+        thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    thread_count = static_cast<unsigned>(std::min(static_cast<size_t>(thread_count),
+                                                  count));
+
+    // The calling thread takes part in the batch instead of idling in join.
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < thread_count; i++) {
+        threads.emplace_back(run);
+    }
+    run();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    return results;
+}
+
+const CompileOptions& Compiler::get_compile_options(
+        const std::vector<Define>& defines) const {
+    if (defines.empty()) {
+        return compile_options_;
+    }
+
+    std::string key;
+    for (const auto& define : defines) {
+        key += define.name;
+        key += '\0';
+        key += define.value;
+        key += '\0';
+    }
+
+    return define_options_->get_or_create(std::move(key), [this, &defines]() {
+        CompileOptions options = compile_options_;
+        options.add_macro_definitions(defines.begin(), defines.end());
+        return options;
+    });
+}
+
+std::uint64_t Compiler::get_spirv_cache_key(const std::string& source,
+                                            const std::string& input_filename,
+                                            ShaderKind shader_kind,
+                                            const std::string& entrypoint_name,
+                                            const std::vector<Define>& defines) const {
+    // The input file name is part of the key because relative includes are resolved
+    // against it. The includes themselves are validated by the cache on lookup.
+    std::uint64_t hash = fnv1a_64("vkbase-spirv-cache-1");
+    hash = fnv1a_64(source, hash);
+    hash = fnv1a_64(input_filename, hash);
+    hash = fnv1a_64(std::to_string(static_cast<int>(shader_kind)), hash);
+    hash = fnv1a_64(entrypoint_name, hash);
+    for (const auto& define : defines) {
+        hash = fnv1a_64(define.name, hash);
+        hash = fnv1a_64(define.value, hash);
+    }
+
+    if (spirv_optimizer_) {
+        hash = fnv1a_64(spirv_optimizer_->state_key(), hash);
+    }
+
+    return fnv1a_64(compile_options_.state_key(), hash);
 }
 
 void CompilationResult::Destroyer::operator()(
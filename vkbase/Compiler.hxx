@@ -2,11 +2,18 @@
 
 #include <shaderc/shaderc.h>
 
+#include <atomic>
 #include <cctype>
 #include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "ConcurrentCache.hxx"
+#include "IncludeCache.hxx"
 #include "UniqueObject.hxx"
 #include "vulkan_helper.hxx"
 
@@ -68,6 +75,43 @@ struct Define {
     std::string value;
 };
 
+// A file pulled in through #include, identified by its content rather than its
+// modification time so that touching a file does not invalidate anything. A failed
+// compile also depends on the #include "..." files it could not find, which are
+// marked missing and have no content hash.
+struct ShaderDependency {
+    std::string path;
+    std::uint64_t content_hash;
+    bool missing = false;
+};
+
+class SpirvCache;
+class SpirvOptimizer;
+
+// A single compilation in a batch. If no source is given, it is read from the input
+// file.
+struct ShaderJob {
+    std::string input_filename;
+    ShaderKind shader_kind;
+    std::optional<std::string> source;
+    std::string entrypoint_name = "main";
+    std::vector<Define> defines;
+};
+
+struct ShaderJobResult {
+    ShaderCompilationStatus status;
+    std::string error_message;
+    std::vector<uint32_t> spirv_code;
+
+    // Every file included by the shader, directly or not. If compilation failed, the
+    // files it got to before failing.
+    std::vector<ShaderDependency> dependencies;
+
+    bool succeeded() const noexcept {
+        return status == ShaderCompilationStatus::Success;
+    }
+};
+
 class ShaderCCompileError : public VkBaseError {
 public:
     ShaderCCompileError(ShaderCompilationStatus status);
@@ -82,29 +126,36 @@ private:
 
 class IncludeResult {
 public:
-    IncludeResult(const std::string& source_name, const std::string&& content);
+    IncludeResult(const std::string& source_name, std::string&& content);
 
     IncludeResult(const std::string& source_name, const std::string& content);
 
     IncludeResult(const std::string& source_name);
 
+    // Shares the content instead of copying it, e.g. with an include cache.
+    IncludeResult(const std::string& source_name,
+                  std::shared_ptr<const std::string> content);
+
     IncludeResult(const IncludeResult& rhs);
-    IncludeResult(IncludeResult&&) noexcept = default;
+    IncludeResult(IncludeResult&& rhs) noexcept;
 
     IncludeResult& operator=(const IncludeResult& rhs);
-    IncludeResult& operator=(IncludeResult&&) noexcept = default;
+    IncludeResult& operator=(IncludeResult&& rhs) noexcept;
 
     static IncludeResult make_error(const std::string& error);
 
     const std::string& source_name() const noexcept { return source_name_; }
 
-    const std::string& content() const noexcept { return content_; }
+    const std::string& content() const noexcept { return *content_; }
 
     const shaderc_include_result& operator*() const noexcept { return include_result_; }
 
+private:
+    void update_include_result() noexcept;
+
 private:
     std::string source_name_;
-    std::string content_;
+    std::shared_ptr<const std::string> content_;
     shaderc_include_result include_result_;
 };
 
@@ -112,6 +163,33 @@ class IncludeResolver {
 public:
     IncludeResolver();
     IncludeResolver(std::size_t max_include_depth);
+    IncludeResolver(std::size_t max_include_depth,
+                    std::shared_ptr<IncludeCache> include_cache);
+
+    // Copies the standard include directories and their index, and shares the include
+    // cache.
+    IncludeResolver(const IncludeResolver& rhs);
+    IncludeResolver& operator=(const IncludeResolver&) = delete;
+
+    // Scans the directory and its subdirectories once so that standard includes
+    // resolve with a single lookup. A name found in several directories resolves to
+    // the directory that was added first. Names are matched without regard to case on
+    // Windows. A name missing from the index is looked for in each directory in turn,
+    // so files added since the scan are still found.
+    void add_standard_include_path(const std::string& path);
+
+    // Scans the standard include directories again to pick up added or removed files.
+    void rescan_standard_include_paths();
+
+    // Changes whenever standard include directories are added or rescanned, which may
+    // make an #include <...> that was not found resolve.
+    std::uint64_t index_version() const noexcept { return index_version_; }
+
+    // Every file is read through this cache, so anything checking whether the files a
+    // shader included changed should read them through it too.
+    const std::shared_ptr<IncludeCache>& include_cache() const noexcept {
+        return include_cache_;
+    }
 
 private:
     IncludeResult* resolve_include(const std::string& requested_source,
@@ -119,6 +197,10 @@ private:
                                    const std::string& requesting_source,
                                    size_t include_depth) const;
 
+    IncludeFile find_standard_include(const std::string& requested_source) const;
+
+    void index_standard_include_path(const std::string& path);
+
     void release_include_result(IncludeResult* include_result) const;
 
     static shaderc_include_result* include_resolve_fn(void* user_data,
@@ -133,6 +215,13 @@ private:
 private:
     std::size_t max_include_depth_;
     std::vector<std::string> standard_include_paths_;
+    std::shared_ptr<IncludeCache> include_cache_;
+
+    // Maps every file under the standard include directories, by its path relative to
+    // the directory, to its absolute path.
+    mutable std::mutex index_mutex_;
+    std::unordered_map<std::string, std::string> standard_include_index_;
+    std::atomic<std::uint64_t> index_version_;
 
     friend class CompileOptions;
 };
@@ -158,24 +247,38 @@ public:
     CompileOptions& operator=(const CompileOptions& rhs);
     CompileOptions& operator=(CompileOptions&&) noexcept = default;
 
-    void set_source_language(ShaderSourceLanguage source_language) const;
-    void set_optimization_level(ShaderOptimizationLevel optimization_level) const;
-    void set_target_env(ShaderTargetEnv target_env, ShaderEnvVersion env_version) const;
-    void add_macro_definition(const Define& define) const;
+    void set_source_language(ShaderSourceLanguage source_language);
+    void set_optimization_level(ShaderOptimizationLevel optimization_level);
+    void set_target_env(ShaderTargetEnv target_env, ShaderEnvVersion env_version);
+    void add_macro_definition(const Define& define);
+    void add_include_directory(const std::string& path);
 
     template <class InputIt>
-    void add_macro_definitions(InputIt first, InputIt last) const {
+    void add_macro_definitions(InputIt first, InputIt last) {
         for (InputIt it = first; it != last; ++it) {
             add_macro_definition(*it);
         }
     }
 
+    // Describes every setting applied so far. Two options objects with the same state
+    // key produce the same SPIR-V from the same source.
+    const std::string& state_key() const noexcept { return state_key_; }
+
+    const IncludeResolver& include_resolver() const noexcept {
+        return *include_resolver_;
+    }
+
 private:
     void assert_exists() const;
 
 private:
     UniqueObject<shaderc_compile_options_t, Destroyer> compile_options_;
-    IncludeResolver include_resolver_;
+
+    // Each copy has its own, so that adding an include directory to one does not
+    // affect the others. Kept at a stable address, since shaderc holds a raw pointer
+    // to it as the include callbacks' user data.
+    std::unique_ptr<IncludeResolver> include_resolver_;
+    std::string state_key_;
 
     friend class CompilationResult;
 };
@@ -212,12 +315,79 @@ public:
                                          const std::string& input_filename,
                                          ShaderKind shader_kind,
                                          const std::string& entrypoint_name = "main",
-                                         const std::vector<Define>& defines = {}) const;
+                                         const std::vector<Define>& defines = {},
+                                         std::vector<ShaderDependency>* dependencies =
+                                                 nullptr) const;
+
+    // Compiles the jobs concurrently and returns one result per job, in order. A
+    // failing job does not affect the others. A thread count of zero uses one thread
+    // per hardware thread.
+    std::vector<ShaderJobResult> compile_batch(const ShaderJob* jobs, size_t count,
+                                               unsigned thread_count = 0) const;
+    std::vector<ShaderJobResult> compile_batch(const std::vector<ShaderJob>& jobs,
+                                               unsigned thread_count = 0) const {
+        return compile_batch(jobs.data(), jobs.size(), thread_count);
+    }
+
+    // Adds a directory searched by #include <...>. Must not be called while other
+    // threads are compiling.
+    void add_include_directory(const std::string& path) {
+        compile_options_.add_include_directory(path);
+
+        // They were copied from the old options, without the new directory.
+        define_options_->clear();
+    }
+
+    // See IncludeResolver::index_version().
+    std::uint64_t include_index_version() const noexcept {
+        return compile_options_.include_resolver().index_version();
+    }
+
+    // See IncludeResolver::include_cache().
+    const std::shared_ptr<IncludeCache>& include_cache() const noexcept {
+        return compile_options_.include_resolver().include_cache();
+    }
+
+    // Compiled SPIR-V is looked up in and stored to the cache, if one is set. Must not
+    // be changed while other threads are compiling.
+    void set_spirv_cache(std::shared_ptr<SpirvCache> spirv_cache) noexcept {
+        spirv_cache_ = std::move(spirv_cache);
+    }
+
+    const std::shared_ptr<SpirvCache>& spirv_cache() const noexcept {
+        return spirv_cache_;
+    }
+
+    // Compiled SPIR-V is run through the optimizer, if one is set, before it is
+    // cached. Must not be changed while other threads are compiling.
+    void set_spirv_optimizer(std::shared_ptr<SpirvOptimizer> spirv_optimizer) noexcept {
+        spirv_optimizer_ = std::move(spirv_optimizer);
+    }
+
+    const std::shared_ptr<SpirvOptimizer>& spirv_optimizer() const noexcept {
+        return spirv_optimizer_;
+    }
+
+private:
+    const CompileOptions& get_compile_options(const std::vector<Define>& defines) const;
+
+    std::uint64_t get_spirv_cache_key(const std::string& source,
+                                      const std::string& input_filename,
+                                      ShaderKind shader_kind,
+                                      const std::string& entrypoint_name,
+                                      const std::vector<Define>& defines) const;
 
 private:
     UniqueObject<shaderc_compiler_t, Destroyer> compiler_;
     CompileOptions compile_options_;
 
+    // Compile options with each define set applied, built once per define set. shaderc
+    // only reads the options, so one object may be used by several compiles at once.
+    std::unique_ptr<ConcurrentCache<std::string, CompileOptions>> define_options_;
+
+    std::shared_ptr<SpirvCache> spirv_cache_;
+    std::shared_ptr<SpirvOptimizer> spirv_optimizer_;
+
     friend class CompilationResult;
 };
 
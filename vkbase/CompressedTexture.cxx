@@ -0,0 +1,369 @@
+#include "CompressedTexture.hxx"
+
+#include <algorithm>
+#include <cstring>
+
+#include "VulkanError.hxx"
+#include "math_helper.hxx"
+#include "vulkan_helper.hxx"
+
+namespace maseya::vkbase {
+namespace {
+constexpr unsigned char ktx2_identifier[12] = {0xAB, 'K',  'T',  'X', ' ',  '2',
+                                               '0',  0xBB, '\r', '\n', 0x1A, '\n'};
+
+struct Ktx2Header {
+    unsigned char identifier[12];
+    uint32_t vk_format;
+    uint32_t type_size;
+    uint32_t pixel_width;
+    uint32_t pixel_height;
+    uint32_t pixel_depth;
+    uint32_t layer_count;
+    uint32_t face_count;
+    uint32_t level_count;
+    uint32_t supercompression_scheme;
+    uint32_t dfd_byte_offset;
+    uint32_t dfd_byte_length;
+    uint32_t kvd_byte_offset;
+    uint32_t kvd_byte_length;
+    uint64_t sgd_byte_offset;
+    uint64_t sgd_byte_length;
+};
+
+struct Ktx2LevelIndex {
+    uint64_t byte_offset;
+    uint64_t byte_length;
+    uint64_t uncompressed_byte_length;
+};
+
+constexpr uint32_t dds_magic = 0x20534444;  // "DDS "
+constexpr uint32_t dds_pixel_format_four_cc = 0x4;
+
+constexpr uint32_t make_four_cc(char a, char b, char c, char d) noexcept {
+    return uint32_t(uint8_t(a)) | uint32_t(uint8_t(b)) << 8 |
+           uint32_t(uint8_t(c)) << 16 | uint32_t(uint8_t(d)) << 24;
+}
+
+struct DdsPixelFormat {
+    uint32_t size;
+    uint32_t flags;
+    uint32_t four_cc;
+    uint32_t rgb_bit_count;
+    uint32_t bit_masks[4];
+};
+
+struct DdsHeader {
+    uint32_t size;
+    uint32_t flags;
+    uint32_t height;
+    uint32_t width;
+    uint32_t pitch_or_linear_size;
+    uint32_t depth;
+    uint32_t mip_map_count;
+    uint32_t reserved1[11];
+    DdsPixelFormat pixel_format;
+    uint32_t caps[4];
+    uint32_t reserved2;
+};
+
+struct DdsHeaderDx10 {
+    uint32_t dxgi_format;
+    uint32_t resource_dimension;
+    uint32_t misc_flag;
+    uint32_t array_size;
+    uint32_t misc_flags2;
+};
+
+constexpr uint32_t dds_resource_dimension_texture2d = 3;
+
+VkFormat get_format_from_four_cc(uint32_t four_cc) noexcept {
+    switch (four_cc) {
+        case make_four_cc('D', 'X', 'T', '1'):
+            return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+        case make_four_cc('D', 'X', 'T', '5'):
+            return VK_FORMAT_BC3_UNORM_BLOCK;
+        case make_four_cc('A', 'T', 'I', '1'):
+        case make_four_cc('B', 'C', '4', 'U'):
+            return VK_FORMAT_BC4_UNORM_BLOCK;
+        case make_four_cc('A', 'T', 'I', '2'):
+        case make_four_cc('B', 'C', '5', 'U'):
+            return VK_FORMAT_BC5_UNORM_BLOCK;
+        default:
+            return VK_FORMAT_UNDEFINED;
+    }
+}
+
+VkFormat get_format_from_dxgi_format(uint32_t dxgi_format) noexcept {
+    switch (dxgi_format) {
+        case 71:
+            return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+        case 72:
+            return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+        case 74:
+            return VK_FORMAT_BC2_UNORM_BLOCK;
+        case 75:
+            return VK_FORMAT_BC2_SRGB_BLOCK;
+        case 77:
+            return VK_FORMAT_BC3_UNORM_BLOCK;
+        case 78:
+            return VK_FORMAT_BC3_SRGB_BLOCK;
+        case 80:
+            return VK_FORMAT_BC4_UNORM_BLOCK;
+        case 81:
+            return VK_FORMAT_BC4_SNORM_BLOCK;
+        case 83:
+            return VK_FORMAT_BC5_UNORM_BLOCK;
+        case 84:
+            return VK_FORMAT_BC5_SNORM_BLOCK;
+        case 95:
+            return VK_FORMAT_BC6H_UFLOAT_BLOCK;
+        case 96:
+            return VK_FORMAT_BC6H_SFLOAT_BLOCK;
+        case 98:
+            return VK_FORMAT_BC7_UNORM_BLOCK;
+        case 99:
+            return VK_FORMAT_BC7_SRGB_BLOCK;
+        default:
+            return VK_FORMAT_UNDEFINED;
+    }
+}
+
+size_t get_level_size(VkFormat format, const VkExtent2D& extent) noexcept {
+    return static_cast<size_t>((extent.width + 3) / 4) * ((extent.height + 3) / 4) *
+           get_block_size(format);
+}
+
+VkExtent2D get_level_extent(const VkExtent2D& extent, uint32_t level) noexcept {
+    return {std::max(extent.width >> level, 1u), std::max(extent.height >> level, 1u)};
+}
+}  // namespace
+
+CompressedTexture::CompressedTexture(const std::string& path)
+        : file_(path, MappedFileHint::Sequential),
+          format_(VK_FORMAT_UNDEFINED),
+          levels_() {
+    if (file_.size() >= sizeof(ktx2_identifier) &&
+        std::memcmp(file_.data(), ktx2_identifier, sizeof(ktx2_identifier)) == 0) {
+        read_ktx2(path);
+    } else {
+        read_dds(path);
+    }
+}
+
+ImageDesc CompressedTexture::get_image_desc() const {
+    ImageDesc result;
+    result.format = format_;
+    result.extent = {extent().width, extent().height, 1};
+    result.mip_levels = mip_levels();
+    return result;
+}
+
+VkDeviceSize CompressedTexture::staging_size() const noexcept {
+    VkDeviceSize result = 0;
+    for (const auto& level : levels_) {
+        result = align_up<VkDeviceSize>(result, get_block_size(format_)) + level.size;
+    }
+
+    return result;
+}
+
+void CompressedTexture::upload(VkCommandBuffer command_buffer, const StagingSpan& span,
+                               VkImage image, VkPipelineStageFlags destination_stage,
+                               VkAccessFlags destination_access) const {
+    if (span.size < staging_size()) {
+        throw VkBaseError("Staging span is too small for the compressed texture.");
+    }
+    if (span.offset % get_block_size(format_) != 0) {
+        throw VkBaseError("Staging span does not start on a compressed block.");
+    }
+
+    // Copies must start on a block boundary in the buffer as well as in the image.
+    std::vector<VkBufferImageCopy> regions;
+    regions.reserve(levels_.size());
+    VkDeviceSize offset = 0;
+    for (uint32_t i = 0; i < mip_levels(); i++) {
+        const CompressedTextureLevel& level = levels_[i];
+        offset = align_up<VkDeviceSize>(offset, get_block_size(format_));
+        std::memcpy(span.data + offset, level_data(i), level.size);
+
+        VkBufferImageCopy region{};
+        region.bufferOffset = span.offset + offset;
+        region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, i, 0, 1};
+        region.imageExtent = {level.extent.width, level.extent.height, 1};
+        regions.push_back(region);
+
+        offset += level.size;
+    }
+
+    image_memory_barrier(command_buffer, image, VK_IMAGE_LAYOUT_UNDEFINED,
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+    vkCmdCopyBufferToImage(command_buffer, span.buffer, image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(regions.size()), regions.data());
+    image_memory_barrier(command_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                         destination_stage, destination_access);
+}
+
+void CompressedTexture::read_ktx2(const std::string& path) {
+    Ktx2Header header;
+    if (file_.size() < sizeof(header)) {
+        throw InvalidPathError("Truncated KTX2 file.", path);
+    }
+
+    std::memcpy(&header, file_.data(), sizeof(header));
+    format_ = static_cast<VkFormat>(header.vk_format);
+    if (get_block_size(format_) == 0) {
+        throw InvalidPathError("KTX2 file is not BC compressed.", path);
+    }
+
+    // Supercompressed payloads (Basis Universal, zstd) would need transcoding first.
+    if (header.supercompression_scheme != 0) {
+        throw InvalidPathError("Supercompressed KTX2 files are not supported.", path);
+    }
+
+    if (header.pixel_width == 0 || header.pixel_height == 0 || header.pixel_depth > 1 ||
+        header.layer_count > 1 || header.face_count != 1) {
+        throw InvalidPathError("Only 2D KTX2 textures are supported.", path);
+    }
+
+    // A level count of zero asks the loader to generate mipmaps, which compressed
+    // formats cannot be blitted for.
+    uint32_t level_count = std::max(header.level_count, 1u);
+    if ((file_.size() - sizeof(header)) / sizeof(Ktx2LevelIndex) < level_count) {
+        throw InvalidPathError("Truncated KTX2 file.", path);
+    }
+
+    VkExtent2D extent{header.pixel_width, header.pixel_height};
+    for (uint32_t i = 0; i < level_count; i++) {
+        Ktx2LevelIndex index;
+        std::memcpy(&index, file_.data() + sizeof(header) + i * sizeof(index),
+                    sizeof(index));
+
+        VkExtent2D level_extent = get_level_extent(extent, i);
+        size_t size = get_level_size(format_, level_extent);
+        if (index.byte_length != size || index.byte_offset > file_.size() ||
+            file_.size() - index.byte_offset < size) {
+            throw InvalidPathError("Corrupt KTX2 level index.", path);
+        }
+
+        levels_.push_back({level_extent, static_cast<size_t>(index.byte_offset), size});
+    }
+}
+
+void CompressedTexture::read_dds(const std::string& path) {
+    uint32_t magic;
+    DdsHeader header;
+    if (file_.size() < sizeof(magic) + sizeof(header)) {
+        throw InvalidPathError("Not a KTX2 or DDS file.", path);
+    }
+
+    std::memcpy(&magic, file_.data(), sizeof(magic));
+    std::memcpy(&header, file_.data() + sizeof(magic), sizeof(header));
+    if (magic != dds_magic || header.size != sizeof(header) ||
+        !(header.pixel_format.flags & dds_pixel_format_four_cc)) {
+        throw InvalidPathError("Not a KTX2 or BC compressed DDS file.", path);
+    }
+
+    size_t offset = sizeof(magic) + sizeof(header);
+    if (header.pixel_format.four_cc == make_four_cc('D', 'X', '1', '0')) {
+        DdsHeaderDx10 dx10_header;
+        if (file_.size() < offset + sizeof(dx10_header)) {
+            throw InvalidPathError("Truncated DDS file.", path);
+        }
+
+        std::memcpy(&dx10_header, file_.data() + offset, sizeof(dx10_header));
+        if (dx10_header.resource_dimension != dds_resource_dimension_texture2d ||
+            dx10_header.array_size > 1) {
+            throw InvalidPathError("Only 2D DDS textures are supported.", path);
+        }
+
+        format_ = get_format_from_dxgi_format(dx10_header.dxgi_format);
+        offset += sizeof(dx10_header);
+    } else {
+        format_ = get_format_from_four_cc(header.pixel_format.four_cc);
+    }
+
+    if (format_ == VK_FORMAT_UNDEFINED) {
+        throw InvalidPathError("DDS file is not BC compressed.", path);
+    }
+
+    if (header.width == 0 || header.height == 0) {
+        throw InvalidPathError("DDS file has no pixels.", path);
+    }
+
+    // Levels are stored largest first with no padding between them.
+    VkExtent2D extent{header.width, header.height};
+    uint32_t level_count = std::max(header.mip_map_count, 1u);
+    for (uint32_t i = 0; i < level_count; i++) {
+        VkExtent2D level_extent = get_level_extent(extent, i);
+        size_t size = get_level_size(format_, level_extent);
+        if (file_.size() - offset < size) {
+            throw InvalidPathError("Truncated DDS file.", path);
+        }
+
+        levels_.push_back({level_extent, offset, size});
+        offset += size;
+    }
+}
+
+VkDeviceSize get_block_size(VkFormat format) noexcept {
+    switch (format) {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+        case VK_FORMAT_BC4_SNORM_BLOCK:
+            return 8;
+
+        case VK_FORMAT_BC2_UNORM_BLOCK:
+        case VK_FORMAT_BC2_SRGB_BLOCK:
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC5_SNORM_BLOCK:
+        case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+        case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            return 16;
+
+        default:
+            return 0;
+    }
+}
+
+bool is_compressed_format_supported(VkPhysicalDevice physical_device, VkFormat format,
+                                    bool maintenance1_enabled) {
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(physical_device, format, &properties);
+
+    VkPhysicalDeviceProperties device_properties;
+    vkGetPhysicalDeviceProperties(physical_device, &device_properties);
+
+    // The version in use is the lower of the instance's and the device's.
+    uint32_t api_version = std::min(vulkan_api_version, device_properties.apiVersion);
+
+    VkFormatFeatureFlags required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+    if (api_version >= VK_API_VERSION_1_1 || maintenance1_enabled) {
+        required |= VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+    }
+    if ((properties.optimalTilingFeatures & required) != required) {
+        return false;
+    }
+
+    // Every format with a block size is a BC format.
+    if (get_block_size(format) != 0) {
+        VkPhysicalDeviceFeatures features;
+        vkGetPhysicalDeviceFeatures(physical_device, &features);
+        return features.textureCompressionBC != VK_FALSE;
+    }
+
+    return true;
+}
+}  // namespace maseya::vkbase
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vulkan/vulkan_core.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "ImageDesc.hxx"
+#include "MappedFile.hxx"
+#include "StagingRing.hxx"
+
+namespace maseya::vkbase {
+struct CompressedTextureLevel {
+    VkExtent2D extent;
+
+    // Into the mapped file.
+    size_t offset;
+    size_t size;
+};
+
+// A block compressed 2D texture read from a KTX2 or DDS file, with BC1 through BC7
+// payloads. The blocks are uploaded as they are, so the texture takes a quarter to
+// an eighth of the memory and upload bandwidth of the RGBA8 image StbImage would
+// decode.
+//
+// The file is mapped rather than read, so the only copy of the blocks is the one
+// into staging memory.
+class CompressedTexture {
+public:
+    explicit CompressedTexture(const std::string& path);
+
+    CompressedTexture(const CompressedTexture&) = delete;
+    CompressedTexture(CompressedTexture&&) noexcept = default;
+
+    CompressedTexture& operator=(const CompressedTexture&) = delete;
+    CompressedTexture& operator=(CompressedTexture&&) noexcept = default;
+
+    VkFormat format() const noexcept { return format_; }
+    const VkExtent2D& extent() const noexcept { return levels_.front().extent; }
+    uint32_t mip_levels() const noexcept {
+        return static_cast<uint32_t>(levels_.size());
+    }
+
+    const std::vector<CompressedTextureLevel>& levels() const noexcept {
+        return levels_;
+    }
+
+    const std::byte* level_data(uint32_t level) const noexcept {
+        return file_.data() + levels_[level].offset;
+    }
+
+    // An image that holds every level and can be filled by upload().
+    ImageDesc get_image_desc() const;
+
+    // The staging space upload() needs, including alignment between levels.
+    VkDeviceSize staging_size() const noexcept;
+
+    // Copies every level into the span and records the copy into the image, leaving
+    // it in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL and visible to the destination
+    // stage and access, e.g. the shader stages that sample it. The span must be at
+    // least staging_size(), start on a multiple of the block size, e.g. by allocating
+    // it with that alignment, and be flushed before the command buffer is submitted.
+    void upload(VkCommandBuffer command_buffer, const StagingSpan& span, VkImage image,
+                VkPipelineStageFlags destination_stage =
+                        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                VkAccessFlags destination_access = VK_ACCESS_SHADER_READ_BIT) const;
+
+private:
+    void read_ktx2(const std::string& path);
+    void read_dds(const std::string& path);
+
+private:
+    MappedFile file_;
+    VkFormat format_;
+    std::vector<CompressedTextureLevel> levels_;
+};
+
+// 8 or 16 for BC formats, and 0 for anything else.
+VkDeviceSize get_block_size(VkFormat format) noexcept;
+
+// Whether the device can sample the format and copy into it, including whether it
+// supports textureCompressionBC. That feature must also be enabled when creating the
+// device, e.g. through Device's enabled features. Before Vulkan 1.1, drivers only
+// report whether a format can be copied into with VK_KHR_maintenance1, so without it
+// sampling is taken to imply copying, as the 1.0 specification does.
+bool is_compressed_format_supported(VkPhysicalDevice physical_device, VkFormat format,
+                                    bool maintenance1_enabled = false);
+}  // namespace maseya::vkbase
@@ -0,0 +1,36 @@
+#include "ComputePipeline.hxx"
+
+namespace maseya::vkbase {
+ComputePipeline::Destroyer::Destroyer(VkDevice device) noexcept : device(device) {}
+
+void ComputePipeline::Destroyer::operator()(VkPipeline pipeline) const noexcept {
+    vkDestroyPipeline(device, pipeline, nullptr);
+}
+
+ComputePipeline::ComputePipeline(std::nullptr_t) noexcept
+        : device_(nullptr),
+          bindings_(),
+          descriptor_set_layout_(nullptr),
+          pipeline_layout_(nullptr),
+          pipeline_(nullptr) {}
+
+ComputePipeline::ComputePipeline(
+        VkDevice device,
+        const VkDescriptorSetLayoutBinding* descriptor_set_layout_bindings,
+        uint32_t descriptor_set_layout_binding_count, VkShaderModule compute_shader,
+        const VkSpecializationInfo* specialization_info, VkPipelineCache pipeline_cache)
+        : device_(device),
+          bindings_(descriptor_set_layout_bindings,
+                    descriptor_set_layout_bindings +
+                            descriptor_set_layout_binding_count),
+          descriptor_set_layout_(device,
+                                 get_descriptor_set_layout_create_info(bindings_)),
+          pipeline_layout_(device, *descriptor_set_layout_),
+          pipeline_(create_compute_pipeline(device, pipeline_cache, *pipeline_layout_,
+                                            compute_shader, specialization_info),
+                    device) {}
+
+DescriptorPoolManager ComputePipeline::create_descriptor_pool_manager() const {
+    return DescriptorPoolManager(device_, get_descriptor_types(bindings_));
+}
+}  // namespace maseya::vkbase
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "DescriptorPoolManager.hxx"
+#include "DescriptorSetLayout.hxx"
+#include "PipelineLayout.hxx"
+#include "SpecializationInfo.hxx"
+#include "UniqueObject.hxx"
+#include "vulkan_helper.hxx"
+
+namespace maseya::vkbase {
+class ComputePipeline {
+    struct Destroyer {
+        constexpr Destroyer() noexcept : device(nullptr) {}
+
+        Destroyer(VkDevice device) noexcept;
+
+        void operator()(VkPipeline pipeline) const noexcept;
+
+        VkDevice device;
+    };
+
+public:
+    ComputePipeline(std::nullptr_t) noexcept;
+
+    ComputePipeline(VkDevice device,
+                    const std::vector<VkDescriptorSetLayoutBinding>&
+                            descriptor_set_layout_bindings,
+                    VkShaderModule compute_shader)
+            : ComputePipeline(
+                      device, descriptor_set_layout_bindings.data(),
+                      static_cast<uint32_t>(descriptor_set_layout_bindings.size()),
+                      compute_shader) {}
+    ComputePipeline(VkDevice device,
+                    const std::vector<VkDescriptorSetLayoutBinding>&
+                            descriptor_set_layout_bindings,
+                    VkShaderModule compute_shader,
+                    const SpecializationInfo& specialization_info,
+                    VkPipelineCache pipeline_cache = VK_NULL_HANDLE)
+            : ComputePipeline(
+                      device, descriptor_set_layout_bindings.data(),
+                      static_cast<uint32_t>(descriptor_set_layout_bindings.size()),
+                      compute_shader, specialization_info.get(), pipeline_cache) {}
+    template <size_t descriptor_set_layout_binding_count>
+    ComputePipeline(VkDevice device,
+                    const VkDescriptorSetLayoutBinding (&descriptor_set_layout_bindings)
+                            [descriptor_set_layout_binding_count],
+                    VkShaderModule compute_shader)
+            : ComputePipeline(
+                      device, descriptor_set_layout_bindings,
+                      static_cast<uint32_t>(descriptor_set_layout_binding_count),
+                      compute_shader) {}
+    ComputePipeline(VkDevice device,
+                    const VkDescriptorSetLayoutBinding* descriptor_set_layout_bindings,
+                    uint32_t descriptor_set_layout_binding_count,
+                    VkShaderModule compute_shader,
+                    const VkSpecializationInfo* specialization_info = nullptr,
+                    VkPipelineCache pipeline_cache = VK_NULL_HANDLE);
+
+    ComputePipeline(const ComputePipeline&) = delete;
+    ComputePipeline(ComputePipeline&&) noexcept = default;
+
+    ComputePipeline& operator=(const ComputePipeline&) = delete;
+    ComputePipeline& operator=(ComputePipeline&&) noexcept = default;
+
+    VkPipeline operator*() const noexcept { return *pipeline_; }
+
+    explicit operator bool() const noexcept { return static_cast<bool>(pipeline_); }
+
+    VkPipelineLayout pipeline_layout() const noexcept { return *pipeline_layout_; }
+
+    DescriptorPoolManager create_descriptor_pool_manager() const;
+
+private:
+    VkDevice device_;
+    std::vector<VkDescriptorSetLayoutBinding> bindings_;
+    DescriptorSetLayout descriptor_set_layout_;
+    PipelineLayout pipeline_layout_;
+    UniqueObject<VkPipeline, Destroyer> pipeline_;
+};
+}  // namespace maseya::vkbase
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace maseya::vkbase {
+// A read-mostly hash map for caching objects that are created once and then looked up
+// from many threads. Lookups take no lock, inserts lock one of several shards, and
+// references to cached values stay valid until the value is erased.
+//
+// Each shard is an open addressing table of pointers to heap allocated nodes. Growing
+// a shard publishes a new table and keeps the old one alive until the cache is
+// cleared, so a reader may always finish probing the table it started on.
+template <class Key, class Value, class Hasher = std::hash<Key>,
+          class KeyEqual = std::equal_to<Key>>
+class ConcurrentCache {
+    struct Node {
+        std::size_t hash;
+        Key key;
+        Value value;
+    };
+
+    struct Table {
+        explicit Table(std::size_t capacity)
+                : mask(capacity - 1), slots(new std::atomic<Node*>[capacity]) {
+            for (std::size_t i = 0; i < capacity; i++) {
+                slots[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        std::size_t capacity() const noexcept { return mask + 1; }
+
+        std::size_t mask;
+        std::unique_ptr<std::atomic<Node*>[]> slots;
+    };
+
+    static constexpr std::size_t shard_bits = 4;
+    static constexpr std::size_t shard_count = std::size_t(1) << shard_bits;
+    static constexpr std::size_t initial_capacity = 16;
+
+    class Shard {
+    public:
+        Shard() : mutex_(), table_(nullptr), tables_(), nodes_() { reset(); }
+
+        const Value* find(std::size_t hash, const Key& key) const noexcept {
+            return find(table_.load(std::memory_order_acquire), hash, key);
+        }
+
+        const Value& insert(std::unique_ptr<Node> node) {
+            std::lock_guard lock(mutex_);
+
+            // Another thread may have inserted the same key while this node's value
+            // was being created. Keep the first one and discard ours.
+            Table* table = table_.load(std::memory_order_relaxed);
+            if (const Value* value = find(table, node->hash, node->key)) {
+                return *value;
+            }
+
+            // Keep the load factor under 3/4 so that every probe reaches an empty slot.
+            if ((nodes_.size() + 1) * 4 > table->capacity() * 3) {
+                table = rebuild(table->capacity() * 2);
+            }
+
+            // Own the node before publishing it, so that a failed push_back cannot
+            // leave the table pointing at a freed node.
+            nodes_.push_back(std::move(node));
+            place(*table, nodes_.back().get());
+            return nodes_.back()->value;
+        }
+
+        bool erase(std::size_t hash, const Key& key) {
+            std::lock_guard lock(mutex_);
+
+            auto it = std::find_if(nodes_.begin(), nodes_.end(),
+                                   [hash, &key](const std::unique_ptr<Node>& node) {
+                                       return node->hash == hash &&
+                                              KeyEqual()(node->key, key);
+                                   });
+            if (it == nodes_.end()) {
+                return false;
+            }
+
+            nodes_.erase(it);
+
+            // Open addressing cannot simply clear the slot without breaking probe
+            // chains, so rebuild the table. No readers may be active, so the old
+            // tables can be released as well.
+            rebuild(table_.load(std::memory_order_relaxed)->capacity());
+            tables_.erase(tables_.begin(), tables_.end() - 1);
+            return true;
+        }
+
+        void clear() {
+            std::lock_guard lock(mutex_);
+            reset();
+        }
+
+        std::size_t size() const {
+            std::lock_guard lock(mutex_);
+            return nodes_.size();
+        }
+
+    private:
+        static const Value* find(const Table* table, std::size_t hash,
+                                 const Key& key) noexcept {
+            for (std::size_t i = (hash >> shard_bits) & table->mask;;
+                 i = (i + 1) & table->mask) {
+                const Node* node = table->slots[i].load(std::memory_order_acquire);
+                if (!node) {
+                    return nullptr;
+                }
+
+                if (node->hash == hash && KeyEqual()(node->key, key)) {
+                    return &node->value;
+                }
+            }
+        }
+
+        static void place(Table& table, Node* node) noexcept {
+            std::size_t i = (node->hash >> shard_bits) & table.mask;
+            while (table.slots[i].load(std::memory_order_relaxed)) {
+                i = (i + 1) & table.mask;
+            }
+
+            table.slots[i].store(node, std::memory_order_release);
+        }
+
+        Table* rebuild(std::size_t capacity) {
+            auto table = std::make_unique<Table>(capacity);
+            for (const auto& node : nodes_) {
+                place(*table, node.get());
+            }
+
+            tables_.push_back(std::move(table));
+            table_.store(tables_.back().get(), std::memory_order_release);
+            return tables_.back().get();
+        }
+
+        void reset() {
+            nodes_.clear();
+            tables_.clear();
+            tables_.push_back(std::make_unique<Table>(initial_capacity));
+            table_.store(tables_.back().get(), std::memory_order_release);
+        }
+
+    private:
+        mutable std::mutex mutex_;
+        std::atomic<Table*> table_;
+        std::vector<std::unique_ptr<Table>> tables_;
+        std::vector<std::unique_ptr<Node>> nodes_;
+    };
+
+public:
+    ConcurrentCache() : shards_() {}
+
+    ConcurrentCache(const ConcurrentCache&) = delete;
+    ConcurrentCache& operator=(const ConcurrentCache&) = delete;
+
+    // Returns null if the key is not cached. Never blocks.
+    const Value* find(const Key& key) const noexcept {
+        std::size_t hash = Hasher()(key);
+        return get_shard(hash).find(hash, key);
+    }
+
+    // Calls the factory to create the value on a miss. The factory runs without any
+    // lock held, so two threads missing on the same key may both create a value; only
+    // the first one inserted is kept.
+    template <class Factory>
+    const Value& get_or_create(Key key, Factory&& factory) {
+        std::size_t hash = Hasher()(key);
+        Shard& shard = get_shard(hash);
+        if (const Value* value = shard.find(hash, key)) {
+            return *value;
+        }
+
+        std::unique_ptr<Node> node(
+                new Node{hash, std::move(key), std::forward<Factory>(factory)()});
+        return shard.insert(std::move(node));
+    }
+
+    // Erasing and clearing invalidate references to the removed values and must not
+    // run concurrently with any other call.
+    bool erase(const Key& key) {
+        std::size_t hash = Hasher()(key);
+        return get_shard(hash).erase(hash, key);
+    }
+
+    void clear() {
+        for (auto& shard : shards_) {
+            shard.clear();
+        }
+    }
+
+    std::size_t size() const {
+        std::size_t result = 0;
+        for (const auto& shard : shards_) {
+            result += shard.size();
+        }
+
+        return result;
+    }
+
+private:
+    Shard& get_shard(std::size_t hash) noexcept {
+        return shards_[hash & (shard_count - 1)];
+    }
+    const Shard& get_shard(std::size_t hash) const noexcept {
+        return shards_[hash & (shard_count - 1)];
+    }
+
+private:
+    std::array<Shard, shard_count> shards_;
+};
+}  // namespace maseya::vkbase
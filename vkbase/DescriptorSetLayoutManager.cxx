@@ -8,7 +8,7 @@
 namespace maseya::vkbase {
 std::size_t DescriptorSetLayoutManager::DescriptorSetLayoutBinding::Hasher::operator()(
         const DescriptorSetLayoutBinding& obj) const noexcept {
-    std::size_t result;
+    std::size_t result = 0;
     hash_combine(result, obj.binding_);
     hash_combine(result, obj.descriptor_type_);
     hash_combine(result, obj.descriptor_count_);
@@ -29,12 +29,16 @@ DescriptorSetLayoutManager::DescriptorSetLayoutBinding::DescriptorSetLayoutBindi
           descriptor_type_(descriptor_type),
           descriptor_count_(descriptor_count),
           stage_flags_(stage_flags),
-          immutable_samplers_(immutable_samplers,
-                              immutable_samplers + descriptor_count),
+          immutable_samplers_(),
           descriptor_binding_flags_(descriptor_binding_flags),
           mutable_descriptor_types_(
                   mutable_descriptor_types,
-                  mutable_descriptor_types + mutable_descriptor_type_count) {}
+                  mutable_descriptor_types + mutable_descriptor_type_count) {
+    if (immutable_samplers) {
+        immutable_samplers_.insert(immutable_samplers,
+                                   immutable_samplers + descriptor_count);
+    }
+}
 
 bool DescriptorSetLayoutManager::DescriptorSetLayoutBinding::operator==(
         const DescriptorSetLayoutBinding& rhs) const noexcept {
@@ -142,7 +146,8 @@ bool DescriptorSetLayoutManager::DescriptorSetLayoutKey::operator==(
 }
 
 DescriptorSetLayoutManager::DescriptorSetLayoutManager(VkDevice device)
-        : device_(device) {}
+        : device_(device),
+          descriptor_set_layouts_(std::make_unique<DescriptorSetLayoutCache>()) {}
 
 const DescriptorSetLayout& DescriptorSetLayoutManager::get_descriptor_set_layout(
         const std::vector<VkDescriptorSetLayoutBinding>& bindings) {
@@ -151,15 +156,10 @@ const DescriptorSetLayout& DescriptorSetLayoutManager::get_descriptor_set_layout
 
 const DescriptorSetLayout& DescriptorSetLayoutManager::get_descriptor_set_layout(
         const VkDescriptorSetLayoutCreateInfo& create_info) {
-    DescriptorSetLayoutKey key(create_info);
-    auto it = descriptor_set_layouts_.find(key);
-    if (it != descriptor_set_layouts_.end()) {
-        return it->second;
-    }
-
-    auto result = descriptor_set_layouts_.emplace(
-            create_info, DescriptorSetLayout(device_, create_info));
-    return result.first->second;
+    return descriptor_set_layouts_->get_or_create(
+            DescriptorSetLayoutKey(create_info), [this, &create_info]() {
+                return DescriptorSetLayout(device_, create_info);
+            });
 }
 
 void DescriptorSetLayoutManager::erase(
@@ -169,8 +169,8 @@ void DescriptorSetLayoutManager::erase(
 
 void DescriptorSetLayoutManager::erase(
         const VkDescriptorSetLayoutCreateInfo& create_info) {
-    descriptor_set_layouts_.erase(DescriptorSetLayoutKey(create_info));
+    descriptor_set_layouts_->erase(DescriptorSetLayoutKey(create_info));
 }
 
-void DescriptorSetLayoutManager::clear() { descriptor_set_layouts_.clear(); }
+void DescriptorSetLayoutManager::clear() { descriptor_set_layouts_->clear(); }
 }  // namespace maseya::vkbase
\ No newline at end of file
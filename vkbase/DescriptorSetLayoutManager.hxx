@@ -2,9 +2,10 @@
 
 #include <vulkan/vulkan_core.h>
 
-#include <unordered_map>
+#include <memory>
 #include <unordered_set>
 
+#include "ConcurrentCache.hxx"
 #include "DescriptorSetLayout.hxx"
 
 namespace maseya::vkbase {
@@ -64,6 +65,10 @@ class DescriptorSetLayoutManager {
         friend class DescriptorSetLayoutManager;
     };
 
+    using DescriptorSetLayoutCache =
+            ConcurrentCache<DescriptorSetLayoutKey, DescriptorSetLayout,
+                            DescriptorSetLayoutKey::Hasher>;
+
 public:
     DescriptorSetLayoutManager(std::nullptr_t)
             : device_(nullptr), descriptor_set_layouts_() {}
@@ -76,6 +81,8 @@ public:
     DescriptorSetLayoutManager& operator=(const DescriptorSetLayoutManager&) = delete;
     DescriptorSetLayoutManager& operator=(DescriptorSetLayoutManager&&) = default;
 
+    // Safe to call from multiple threads. The returned reference stays valid until the
+    // layout is erased or the manager is cleared.
     const DescriptorSetLayout& get_descriptor_set_layout(
             const std::vector<VkDescriptorSetLayoutBinding>& bindings);
 
@@ -84,6 +91,7 @@ public:
 
     VkDevice device() const noexcept { return device_; }
 
+    // Erasing and clearing must not run concurrently with any other call.
     void erase(const std::vector<VkDescriptorSetLayoutBinding>& bindings);
 
     void erase(const VkDescriptorSetLayoutCreateInfo& create_info);
@@ -92,8 +100,6 @@ public:
 
 private:
     VkDevice device_;
-    std::unordered_map<DescriptorSetLayoutKey, DescriptorSetLayout,
-                       DescriptorSetLayoutKey::Hasher>
-            descriptor_set_layouts_;
+    std::unique_ptr<DescriptorSetLayoutCache> descriptor_set_layouts_;
 };
 }  // namespace maseya::vkbase
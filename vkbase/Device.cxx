@@ -4,6 +4,39 @@
 #include "vulkan_helper.hxx"
 
 namespace maseya::vkbase {
+namespace {
+bool is_device_extension_supported(VkPhysicalDevice physical_device,
+                                   const char* extension) {
+    return get_unsupported_device_extensions(physical_device, &extension, 1).empty();
+}
+
+VkDevice create_instrumented_device(
+        VkPhysicalDevice physical_device,
+        const std::unordered_set<uint32_t>& queue_family_indices,
+        bool pipeline_creation_feedback_enabled,
+        bool pipeline_executable_properties_enabled,
+        const VkPhysicalDeviceFeatures& enabled_features) {
+    std::vector<const char*> optional_extensions;
+    if (pipeline_creation_feedback_enabled) {
+        optional_extensions.push_back(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+    }
+
+    VkPhysicalDevicePipelineExecutablePropertiesFeaturesKHR executable_features{};
+    executable_features.sType =
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PIPELINE_EXECUTABLE_PROPERTIES_FEATURES_KHR;
+    if (pipeline_executable_properties_enabled) {
+        optional_extensions.push_back(
+                VK_KHR_PIPELINE_EXECUTABLE_PROPERTIES_EXTENSION_NAME);
+        executable_features.pipelineExecutableInfo = VK_TRUE;
+    }
+
+    return create_device(
+            physical_device, queue_family_indices, optional_extensions,
+            pipeline_executable_properties_enabled ? &executable_features : nullptr,
+            &enabled_features);
+}
+}  // namespace
+
 void Device::DeviceDestroyer::operator()(VkDevice device) const noexcept {
     vkDestroyDevice(device, nullptr);
 }
@@ -14,8 +47,23 @@ void Device::AllocatorDestroyer::operator()(VmaAllocator allocator) const noexce
 
 Device::Device(VkInstance instance, VkPhysicalDevice physical_device,
                const std::unordered_set<uint32_t>& queue_family_indices,
-               VkFormat default_image_format)
-        : device_(create_device(physical_device, queue_family_indices)),
+               VkFormat default_image_format, bool enable_pipeline_instrumentation,
+               const VkPhysicalDeviceFeatures& enabled_features)
+        : pipeline_creation_feedback_enabled_(
+                  enable_pipeline_instrumentation &&
+                  is_device_extension_supported(
+                          physical_device,
+                          VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME)),
+          pipeline_executable_properties_enabled_(
+                  enable_pipeline_instrumentation &&
+                  is_device_extension_supported(
+                          physical_device,
+                          VK_KHR_PIPELINE_EXECUTABLE_PROPERTIES_EXTENSION_NAME)),
+          enabled_features_(enabled_features),
+          device_(create_instrumented_device(physical_device, queue_family_indices,
+                                             pipeline_creation_feedback_enabled_,
+                                             pipeline_executable_properties_enabled_,
+                                             enabled_features_)),
           allocator_(create_allocator(instance, physical_device, *device_)),
           default_image_format_(default_image_format) {}
 
@@ -19,13 +19,22 @@ class Device {
 
 public:
     constexpr Device(std::nullptr_t) noexcept
-            : device_(nullptr),
+            : pipeline_creation_feedback_enabled_(false),
+              pipeline_executable_properties_enabled_(false),
+              enabled_features_{},
+              device_(nullptr),
               allocator_(nullptr),
               default_image_format_(VK_FORMAT_UNDEFINED) {}
 
+    // Pipeline instrumentation enables VK_EXT_pipeline_creation_feedback and
+    // VK_KHR_pipeline_executable_properties where the physical device supports them.
+    // The enabled features, such as textureCompressionBC for CompressedTexture, must
+    // be supported by the physical device.
     Device(VkInstance instance, VkPhysicalDevice physical_device,
            const std::unordered_set<uint32_t>& queue_family_indices,
-           VkFormat default_image_format);
+           VkFormat default_image_format,
+           bool enable_pipeline_instrumentation = false,
+           const VkPhysicalDeviceFeatures& enabled_features = {});
 
     Device(const Device&) = delete;
     Device(Device&&) noexcept = default;
@@ -40,11 +49,27 @@ public:
 
     VkFormat default_image_format() const noexcept { return default_image_format_; }
 
+    bool pipeline_creation_feedback_enabled() const noexcept {
+        return pipeline_creation_feedback_enabled_;
+    }
+
+    bool pipeline_executable_properties_enabled() const noexcept {
+        return pipeline_executable_properties_enabled_;
+    }
+
+    const VkPhysicalDeviceFeatures& enabled_features() const noexcept {
+        return enabled_features_;
+    }
+
     explicit operator bool() const noexcept { return static_cast<bool>(device_); }
 
     void wait_idle() const;
 
 private:
+    bool pipeline_creation_feedback_enabled_;
+    bool pipeline_executable_properties_enabled_;
+    VkPhysicalDeviceFeatures enabled_features_;
+
     UniqueObject<VkDevice, DeviceDestroyer> device_;
     UniqueObject<VmaAllocator, AllocatorDestroyer> allocator_;
 
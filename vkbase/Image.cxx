@@ -11,19 +11,26 @@ void Image::Destroyer::operator()(vma_image& image) const noexcept {
 }
 
 Image::Image(VkFormat format, const VkExtent2D& extent, VkImageType image_type,
-             UniqueImage&& image)
+             uint32_t mip_levels, uint32_t array_layers, UniqueImage&& image)
         : ImageBase(format, image_type, extent, image->image),
+          mip_levels_(mip_levels),
+          array_layers_(array_layers),
           image_(std::move(image)) {}
 
 Image::Image(VkDevice device, VmaAllocator allocator, VkFormat image_format,
              uint32_t extent)
-        : Image(image_format, {extent, 1}, VK_IMAGE_TYPE_1D,
+        : Image(image_format, {extent, 1}, VK_IMAGE_TYPE_1D, 1, 1,
                 UniqueImage(create_image(allocator, extent, image_format), allocator)) {
 }
 
 Image::Image(VkDevice device, VmaAllocator allocator, VkFormat image_format,
              const VkExtent2D& extent)
-        : Image(image_format, extent, VK_IMAGE_TYPE_2D,
+        : Image(image_format, extent, VK_IMAGE_TYPE_2D, 1, 1,
                 UniqueImage(create_image(allocator, extent, image_format), allocator)) {
 }
+
+Image::Image(VkDevice device, VmaAllocator allocator, const ImageDesc& desc)
+        : Image(desc.format, {desc.extent.width, desc.extent.height}, desc.image_type,
+                desc.mip_levels, desc.array_layers,
+                UniqueImage(create_image(allocator, desc), allocator)) {}
 }  // namespace maseya::vkbase
\ No newline at end of file
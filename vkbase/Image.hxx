@@ -3,6 +3,7 @@
 #include <vulkan/vulkan.h>
 
 #include "Device.hxx"
+#include "ImageDesc.hxx"
 #include "ImageBase.hxx"
 #include "UniqueObject.hxx"
 #include "vma_helper.hxx"
@@ -22,17 +23,19 @@ class Image : public ImageBase {
     using UniqueImage = UniqueObject<vma_image, Destroyer>;
 
 public:
-    constexpr Image(std::nullptr_t) noexcept : ImageBase(nullptr), image_(nullptr) {}
+    constexpr Image(std::nullptr_t) noexcept
+            : ImageBase(nullptr), mip_levels_(0), array_layers_(0), image_(nullptr) {}
 
 private:
     Image(VkFormat format, const VkExtent2D& extent, VkImageType image_type,
-          UniqueImage&& image);
+          uint32_t mip_levels, uint32_t array_layers, UniqueImage&& image);
 
 public:
     Image(VkDevice device, VmaAllocator allocator, VkFormat image_format,
           uint32_t extent);
     Image(VkDevice device, VmaAllocator allocator, VkFormat image_format,
           const VkExtent2D& extent);
+    Image(VkDevice device, VmaAllocator allocator, const ImageDesc& desc);
 
     Image(const Image&) = delete;
     Image(Image&&) noexcept = default;
@@ -40,7 +43,12 @@ public:
     Image& operator=(const Image&) = delete;
     Image& operator=(Image&&) noexcept = default;
 
+    uint32_t mip_levels() const noexcept { return mip_levels_; }
+    uint32_t array_layers() const noexcept { return array_layers_; }
+
 private:
+    uint32_t mip_levels_;
+    uint32_t array_layers_;
     UniqueImage image_;
 };
 }  // namespace maseya::vkbase
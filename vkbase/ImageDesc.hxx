@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vma/vk_mem_alloc.h>
+#include <vulkan/vulkan_core.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace maseya::vkbase {
+// Everything needed to create an image. The defaults describe a single level sampled
+// texture that is filled by a transfer.
+//
+// Only request the usage the image needs. Drivers may not compress images that can be
+// used as storage or as attachments, for instance.
+struct ImageDesc {
+    VkImageType image_type = VK_IMAGE_TYPE_2D;
+    VkFormat format = VK_FORMAT_R8G8B8A8_UNORM;
+    VkExtent3D extent = {1, 1, 1};
+    uint32_t mip_levels = 1;
+    uint32_t array_layers = 1;
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+    VkImageTiling tiling = VK_IMAGE_TILING_OPTIMAL;
+    VkImageUsageFlags usage =
+            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    VkImageCreateFlags flags = 0;
+    VmaMemoryUsage memory_usage = VMA_MEMORY_USAGE_GPU_ONLY;
+};
+
+// The number of levels in a full mip chain, down to 1x1.
+inline uint32_t get_mip_level_count(const VkExtent3D& extent) noexcept {
+    uint32_t size = std::max({extent.width, extent.height, extent.depth});
+    uint32_t result = 1;
+    while (size > 1) {
+        size /= 2;
+        result++;
+    }
+
+    return result;
+}
+
+inline uint32_t get_mip_level_count(const VkExtent2D& extent) noexcept {
+    return get_mip_level_count(VkExtent3D{extent.width, extent.height, 1});
+}
+
+// The size of a mip level, which never goes below 1 in any dimension.
+inline VkExtent3D get_mip_level_extent(const VkExtent3D& extent,
+                                       uint32_t mip_level) noexcept {
+    return {std::max(extent.width >> mip_level, 1u),
+            std::max(extent.height >> mip_level, 1u),
+            std::max(extent.depth >> mip_level, 1u)};
+}
+
+// A 2D texture with a full mip chain, to be filled by a transfer into level 0 and
+// generate_mipmaps().
+inline ImageDesc get_mipmapped_image_desc(VkFormat format, const VkExtent2D& extent) {
+    ImageDesc result;
+    result.format = format;
+    result.extent = {extent.width, extent.height, 1};
+    result.mip_levels = get_mip_level_count(extent);
+    result.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                   VK_IMAGE_USAGE_SAMPLED_BIT;
+    return result;
+}
+}  // namespace maseya::vkbase
@@ -16,4 +16,8 @@ Image ImageFactory::create_image(VkFormat format, uint32_t width) {
 Image ImageFactory::create_image(VkFormat format, const VkExtent2D& extent) {
     return Image(device_, allocator, format, extent);
 }
+
+Image ImageFactory::create_image(const ImageDesc& desc) {
+    return Image(device_, allocator, desc);
+}
 }  // namespace maseya::vkbase
\ No newline at end of file
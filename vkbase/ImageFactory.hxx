@@ -21,6 +21,8 @@ public:
         return create_image(default_image_format_, extent);
     }
 
+    Image create_image(const ImageDesc& desc);
+
 private:
     VkDevice device_;
     VmaAllocator allocator;
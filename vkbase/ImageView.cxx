@@ -15,4 +15,11 @@ ImageView::ImageView(VkDevice device, VkImage image, VkFormat format,
                                         image_view_type),
                       device) {}
 
+ImageView::ImageView(VkDevice device, VkImage image, VkFormat format,
+                     const VkImageSubresourceRange& subresource_range,
+                     VkImageViewType image_view_type)
+        : image_view_(create_image_view(device, image, format, subresource_range,
+                                        image_view_type),
+                      device) {}
+
 }  // namespace maseya::vkbase
\ No newline at end of file
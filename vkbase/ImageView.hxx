@@ -23,6 +23,11 @@ public:
               VkImageAspectFlags aspect_mask = VK_IMAGE_ASPECT_COLOR_BIT,
               VkImageViewType image_view_type = VK_IMAGE_VIEW_TYPE_2D);
 
+    // Views a range of mip levels or array layers, e.g. a single level to render to.
+    ImageView(VkDevice device, VkImage image, VkFormat format,
+              const VkImageSubresourceRange& subresource_range,
+              VkImageViewType image_view_type = VK_IMAGE_VIEW_TYPE_2D);
+
     ImageView(const ImageView&) = delete;
     ImageView(ImageView&&) noexcept = default;
 
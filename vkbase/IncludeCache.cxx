@@ -0,0 +1,107 @@
+#include "IncludeCache.hxx"
+
+#include "VulkanError.hxx"
+#include "math_helper.hxx"
+#include "read_file.hxx"
+
+namespace maseya::vkbase {
+namespace fs = std::filesystem;
+
+namespace {
+// Normalizing lexically avoids touching the filesystem for every path component, at
+// the cost of caching a file twice if it is reached through two symlinks.
+std::string get_key(const std::string& path) {
+    return fs::absolute(path).lexically_normal().string();
+}
+}  // namespace
+
+IncludeCache::IncludeCache() : mutex_(), files_() {}
+
+IncludeFile IncludeCache::get(const std::string& path) {
+    std::string key = get_key(path);
+
+    std::error_code ec;
+    fs::file_time_type last_write_time = fs::last_write_time(key, ec);
+    std::uintmax_t size = ec ? 0 : fs::file_size(key, ec);
+    if (ec) {
+        return IncludeFile{std::move(key), nullptr, 0};
+    }
+
+    {
+        std::lock_guard lock(mutex_);
+        auto it = files_.find(key);
+        if (it != files_.end() && it->second.last_write_time == last_write_time &&
+            it->second.size == size) {
+            return IncludeFile{std::move(key), it->second.content,
+                               it->second.content_hash};
+        }
+    }
+
+    // Read outside the lock so that a large file does not stall other lookups. The
+    // file may have been removed since it was stat'ed. It is read rather than mapped,
+    // as an editor may truncate it at any time.
+    std::shared_ptr<const std::string> content;
+    try {
+        content = std::make_shared<const std::string>(read_file(key));
+    } catch (const InvalidPathError&) {
+        return IncludeFile{std::move(key), nullptr, 0};
+    }
+
+    std::uint64_t content_hash = fnv1a_64(*content);
+
+    std::lock_guard lock(mutex_);
+    files_[key] = CachedFile{last_write_time, size, content, content_hash};
+    return IncludeFile{std::move(key), std::move(content), content_hash};
+}
+
+void IncludeCache::prefetch(const std::vector<std::string>& paths,
+                            AsyncFileLoader& loader) {
+    std::vector<std::string> keys;
+    std::vector<CachedFile> files;
+    for (const auto& path : paths) {
+        std::string key = get_key(path);
+        std::error_code ec;
+        fs::file_time_type last_write_time = fs::last_write_time(key, ec);
+        std::uintmax_t size = ec ? 0 : fs::file_size(key, ec);
+        if (ec) {
+            continue;
+        }
+
+        std::lock_guard lock(mutex_);
+        auto it = files_.find(key);
+        if (it == files_.end() || it->second.last_write_time != last_write_time ||
+            it->second.size != size) {
+            keys.push_back(std::move(key));
+            files.push_back(CachedFile{last_write_time, size, nullptr, 0});
+        }
+    }
+
+    std::vector<std::future<std::vector<std::byte>>> futures = loader.load_batch(keys);
+    for (size_t i = 0; i < keys.size(); i++) {
+        std::vector<std::byte> data;
+        try {
+            data = futures[i].get();
+        } catch (const InvalidPathError&) {
+            continue;
+        }
+
+        files[i].content = std::make_shared<const std::string>(
+                reinterpret_cast<const char*>(data.data()), data.size());
+        files[i].content_hash = fnv1a_64(*files[i].content);
+
+        std::lock_guard lock(mutex_);
+        files_[keys[i]] = std::move(files[i]);
+    }
+}
+
+void IncludeCache::clear() {
+    std::lock_guard lock(mutex_);
+    files_.clear();
+}
+
+const std::shared_ptr<IncludeCache>& IncludeCache::get_shared() {
+    static const std::shared_ptr<IncludeCache> include_cache =
+            std::make_shared<IncludeCache>();
+    return include_cache;
+}
+}  // namespace maseya::vkbase
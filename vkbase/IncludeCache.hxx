@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "AsyncFileLoader.hxx"
+
+namespace maseya::vkbase {
+struct IncludeFile {
+    std::string path;
+    std::shared_ptr<const std::string> content;
+    std::uint64_t content_hash;
+};
+
+// Holds the contents of include files in memory, keyed by normalized absolute path, so
+// that a header included by many shaders is read from disk once. A cached file is
+// reread when its modification time or size changes. Safe to use from multiple
+// threads.
+class IncludeCache {
+public:
+    IncludeCache();
+
+    IncludeCache(const IncludeCache&) = delete;
+    IncludeCache& operator=(const IncludeCache&) = delete;
+
+    // Returns an entry with null content if the file does not exist.
+    IncludeFile get(const std::string& path);
+
+    // Reads the files that are missing or out of date all at once through the loader,
+    // so that the get() calls that follow find them cached. Missing files are skipped.
+    void prefetch(const std::vector<std::string>& paths, AsyncFileLoader& loader);
+
+    void clear();
+
+    // The cache used by include resolvers that are not given one.
+    static const std::shared_ptr<IncludeCache>& get_shared();
+
+private:
+    struct CachedFile {
+        std::filesystem::file_time_type last_write_time;
+        std::uintmax_t size;
+        std::shared_ptr<const std::string> content;
+        std::uint64_t content_hash;
+    };
+
+private:
+    std::mutex mutex_;
+    std::unordered_map<std::string, CachedFile> files_;
+};
+}  // namespace maseya::vkbase
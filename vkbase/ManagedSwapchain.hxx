@@ -35,6 +35,8 @@ public:
         return static_cast<uint32_t>(frames_.size());
     }
 
+    const std::vector<Frame>& frames() const noexcept { return frames_; }
+
     Frame& current_frame() { return frames_[current_frame_]; }
     const Frame& current_frame() const { return frames_[current_frame_]; }
 
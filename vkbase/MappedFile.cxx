@@ -0,0 +1,99 @@
+#include "MappedFile.hxx"
+
+#include <Windows.h>
+
+#include <utility>
+
+#include "VulkanError.hxx"
+
+namespace maseya::vkbase {
+MappedFile::MappedFile(const std::string& path, MappedFileHint hint)
+        : data_(nullptr), size_(0) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw InvalidPathError("Could not open file.", path);
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        DWORD error_code = GetLastError();
+        CloseHandle(file);
+        throw VulkanWinApiError(error_code, "Could not get file size.");
+    }
+
+    // Empty files cannot be mapped.
+    if (file_size.QuadPart == 0) {
+        CloseHandle(file);
+        return;
+    }
+
+    // The view keeps the mapping and the file open, so both handles can be closed.
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    DWORD error_code = GetLastError();
+    CloseHandle(file);
+    if (!mapping) {
+        throw VulkanWinApiError(error_code, "Could not map file.");
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    error_code = GetLastError();
+    CloseHandle(mapping);
+    if (!view) {
+        throw VulkanWinApiError(error_code, "Could not map file.");
+    }
+
+    data_ = static_cast<const std::byte*>(view);
+    size_ = static_cast<size_t>(file_size.QuadPart);
+
+    if (hint != MappedFileHint::Normal) {
+        advise(hint);
+    }
+}
+
+MappedFile::MappedFile(MappedFile&& rhs) noexcept
+        : data_(std::exchange(rhs.data_, nullptr)),
+          size_(std::exchange(rhs.size_, 0)) {}
+
+MappedFile::~MappedFile() { reset(); }
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs) noexcept {
+    std::swap(data_, rhs.data_);
+    std::swap(size_, rhs.size_);
+    return *this;
+}
+
+void MappedFile::advise(MappedFileHint hint) const noexcept {
+    if (!data_) {
+        return;
+    }
+
+    // Windows has no access pattern hints for mapped views, only prefetching. Hints
+    // only affect performance, so failures are ignored.
+    if (hint == MappedFileHint::WillNeed) {
+        WIN32_MEMORY_RANGE_ENTRY range{const_cast<std::byte*>(data_), size_};
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+}
+
+void MappedFile::check_view(size_t alignment, size_t element_size) const {
+    if (reinterpret_cast<std::uintptr_t>(data_) % alignment != 0) {
+        throw VkBaseError("Mapped file is not aligned for the requested view.");
+    }
+
+    if (size_ % element_size != 0) {
+        throw VkBaseError("Mapped file size is not a multiple of the element size.");
+    }
+}
+
+void MappedFile::reset() noexcept {
+    if (!data_) {
+        return;
+    }
+
+    UnmapViewOfFile(data_);
+
+    data_ = nullptr;
+    size_ = 0;
+}
+}  // namespace maseya::vkbase
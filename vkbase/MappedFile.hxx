@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace maseya::vkbase {
+// A read-only view of contiguous elements, valid while its MappedFile is alive.
+template <class T>
+class MappedFileView {
+public:
+    constexpr MappedFileView() noexcept : data_(nullptr), size_(0) {}
+    constexpr MappedFileView(const T* data, size_t size) noexcept
+            : data_(data), size_(size) {}
+
+    constexpr const T* data() const noexcept { return data_; }
+    constexpr size_t size() const noexcept { return size_; }
+    constexpr size_t size_bytes() const noexcept { return size_ * sizeof(T); }
+    constexpr bool empty() const noexcept { return size_ == 0; }
+
+    constexpr const T* begin() const noexcept { return data_; }
+    constexpr const T* end() const noexcept { return data_ + size_; }
+
+    constexpr const T& operator[](size_t index) const noexcept { return data_[index]; }
+
+private:
+    const T* data_;
+    size_t size_;
+};
+
+enum class MappedFileHint {
+    Normal,
+    // The file will be read front to back once.
+    Sequential,
+    Random,
+    // The whole file will be read soon, so it should be paged in ahead of time.
+    WillNeed,
+};
+
+// Maps a file read-only into memory, so that it can be read without copying it to
+// the heap. Pages are loaded on first access.
+//
+// Only map files that nothing modifies while they are mapped, such as shader archives
+// and SPIR-V. Windows does not let a mapped file be truncated, so an editor saving
+// over it fails. Use read_file for files that may change.
+class MappedFile {
+public:
+    constexpr MappedFile(std::nullptr_t) noexcept : data_(nullptr), size_(0) {}
+
+    explicit MappedFile(const std::string& path,
+                        MappedFileHint hint = MappedFileHint::Normal);
+    explicit MappedFile(const char* path, MappedFileHint hint = MappedFileHint::Normal)
+            : MappedFile(std::string(path), hint) {}
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile(MappedFile&& rhs) noexcept;
+
+    ~MappedFile();
+
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&& rhs) noexcept;
+
+    // Null if the file is empty.
+    const std::byte* data() const noexcept { return data_; }
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    MappedFileView<std::byte> bytes() const noexcept { return {data_, size_}; }
+
+    std::string_view text() const noexcept {
+        return std::string_view(reinterpret_cast<const char*>(data_), size_);
+    }
+
+    // Throws if the mapping is not aligned for T or its size is not a multiple of
+    // T's.
+    template <class T>
+    MappedFileView<T> view() const {
+        check_view(alignof(T), sizeof(T));
+        return {reinterpret_cast<const T*>(data_), size_ / sizeof(T)};
+    }
+
+    // SPIR-V is a stream of 32 bit words, so it can be passed as is to
+    // vkCreateShaderModule.
+    MappedFileView<uint32_t> spirv_code() const { return view<uint32_t>(); }
+
+    // Only MappedFileHint::WillNeed has an effect, by prefetching the whole file.
+    void advise(MappedFileHint hint) const noexcept;
+
+private:
+    void check_view(size_t alignment, size_t element_size) const;
+
+    void reset() noexcept;
+
+private:
+    const std::byte* data_;
+    size_t size_;
+};
+}  // namespace maseya::vkbase
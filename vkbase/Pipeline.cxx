@@ -10,9 +10,30 @@ Pipeline::Destroyer::Destroyer(VkDevice device) noexcept : device(device) {}
 Pipeline::Pipeline(std::nullptr_t) noexcept
         : device_(nullptr),
           bindings_(),
-          descriptor_set_layout_(VK_NULL_HANDLE),
-          pipeline_layout_(VK_NULL_HANDLE),
-          pipeline_(VK_NULL_HANDLE) {}
+          descriptor_set_layout_(nullptr),
+          pipeline_layout_(nullptr),
+          pipeline_(nullptr) {}
+
+Pipeline::Pipeline(VkDevice device, VkRenderPass render_pass,
+                   const std::vector<VkDescriptorSetLayoutBinding>&
+                           descriptor_set_layout_bindings,
+                   VkShaderModule vertex_shader,
+                   const SpecializationInfo& vertex_specialization_info,
+                   VkShaderModule fragment_shader,
+                   const SpecializationInfo& fragment_specialization_info,
+                   const std::vector<VkVertexInputBindingDescription>&
+                           vertex_binding_descriptions,
+                   const std::vector<VkVertexInputAttributeDescription>&
+                           vertex_attribute_descriptions,
+                   VkPipelineCache pipeline_cache)
+        : Pipeline(device, render_pass, descriptor_set_layout_bindings.data(),
+                   static_cast<uint32_t>(descriptor_set_layout_bindings.size()),
+                   vertex_shader, fragment_shader, vertex_binding_descriptions.data(),
+                   static_cast<uint32_t>(vertex_binding_descriptions.size()),
+                   vertex_attribute_descriptions.data(),
+                   static_cast<uint32_t>(vertex_attribute_descriptions.size()),
+                   vertex_specialization_info.get(),
+                   fragment_specialization_info.get(), pipeline_cache) {}
 
 Pipeline::Pipeline(
         VkDevice device, VkRenderPass render_pass,
@@ -22,25 +43,27 @@ Pipeline::Pipeline(
         const VkVertexInputBindingDescription* vertex_binding_descriptions,
         uint32_t vertex_binding_description_count,
         const VkVertexInputAttributeDescription* vertex_attribute_descriptions,
-        uint32_t vertex_attribute_description_count)
+        uint32_t vertex_attribute_description_count,
+        const VkSpecializationInfo* vertex_specialization_info,
+        const VkSpecializationInfo* fragment_specialization_info,
+        VkPipelineCache pipeline_cache)
         : device_(device),
           bindings_(
                   descriptor_set_layout_bindings,
                   descriptor_set_layout_bindings + descriptor_set_layot_binding_count),
-          descriptor_set_layout_(create_descriptor_set_layout(device, bindings_),
-                                 device),
-          pipeline_layout_(create_pipeline_layout(device, *descriptor_set_layout_),
-                           device),
-          pipeline_(create_graphics_pipeline(device, render_pass, *pipeline_layout_,
-                                             vertex_shader, fragment_shader,
-                                             vertex_binding_descriptions,
-                                             vertex_binding_description_count,
-                                             vertex_attribute_descriptions,
-                                             vertex_attribute_description_count),
+          descriptor_set_layout_(device,
+                                 get_descriptor_set_layout_create_info(bindings_)),
+          pipeline_layout_(device, *descriptor_set_layout_),
+          pipeline_(create_graphics_pipeline(
+                            device, pipeline_cache, render_pass, *pipeline_layout_,
+                            vertex_shader, vertex_specialization_info, fragment_shader,
+                            fragment_specialization_info, vertex_binding_descriptions,
+                            vertex_binding_description_count,
+                            vertex_attribute_descriptions,
+                            vertex_attribute_description_count),
                     device) {}
 
 DescriptorPoolManager Pipeline::create_descriptor_pool_manager() const {
-    return DescriptorPoolManager(device_, *descriptor_set_layout_,
-                                 get_descriptor_types(bindings_));
+    return DescriptorPoolManager(device_, get_descriptor_types(bindings_));
 }
-}  // namespace maseya::vkbase
\ No newline at end of file
+}  // namespace maseya::vkbase
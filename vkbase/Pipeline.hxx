@@ -5,6 +5,8 @@
 
 #include "DescriptorPoolManager.hxx"
 #include "DescriptorSetLayout.hxx"
+#include "PipelineLayout.hxx"
+#include "SpecializationInfo.hxx"
 #include "UniqueObject.hxx"
 #include "vulkan_helper.hxx"
 
@@ -95,6 +97,18 @@ public:
                        static_cast<uint32_t>(vertex_binding_description_count),
                        vertex_attribute_descriptions,
                        static_cast<uint32_t>(vertex_attribute_description_count)) {}
+    Pipeline(VkDevice device, VkRenderPass render_pass,
+             const std::vector<VkDescriptorSetLayoutBinding>&
+                     descriptor_set_layout_bindings,
+             VkShaderModule vertex_shader,
+             const SpecializationInfo& vertex_specialization_info,
+             VkShaderModule fragment_shader,
+             const SpecializationInfo& fragment_specialization_info,
+             const std::vector<VkVertexInputBindingDescription>&
+                     vertex_binding_descriptions = {},
+             const std::vector<VkVertexInputAttributeDescription>&
+                     vertex_attribute_descriptions = {},
+             VkPipelineCache pipeline_cache = VK_NULL_HANDLE);
     Pipeline(VkDevice device, VkRenderPass render_pass,
              const VkDescriptorSetLayoutBinding* descriptor_set_layout_bindings,
              uint32_t descriptor_set_layout_binding_count, VkShaderModule vertex_shader,
@@ -102,7 +116,10 @@ public:
              const VkVertexInputBindingDescription* vertex_binding_descriptions,
              uint32_t vertex_binding_description_count,
              const VkVertexInputAttributeDescription* vertex_attribute_descriptions,
-             uint32_t vertex_attribute_description_count);
+             uint32_t vertex_attribute_description_count,
+             const VkSpecializationInfo* vertex_specialization_info = nullptr,
+             const VkSpecializationInfo* fragment_specialization_info = nullptr,
+             VkPipelineCache pipeline_cache = VK_NULL_HANDLE);
 
     Pipeline(const Pipeline&) = delete;
     Pipeline(Pipeline&&) noexcept = default;
@@ -112,11 +129,17 @@ public:
 
     VkPipeline operator*() const noexcept { return *pipeline_; }
 
-    operator bool() const noexcept { return static_cast<bool>(pipeline_); }
+    explicit operator bool() const noexcept { return static_cast<bool>(pipeline_); }
+
+    VkPipelineLayout pipeline_layout() const noexcept { return *pipeline_layout_; }
 
     DescriptorPoolManager create_descriptor_pool_manager() const;
 
 private:
+    VkDevice device_;
+    std::vector<VkDescriptorSetLayoutBinding> bindings_;
+    DescriptorSetLayout descriptor_set_layout_;
+    PipelineLayout pipeline_layout_;
     UniqueObject<VkPipeline, Destroyer> pipeline_;
 };
 }  // namespace maseya::vkbase
@@ -0,0 +1,93 @@
+#include "PipelineCache.hxx"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include "VulkanError.hxx"
+#include "vulkan_helper.hxx"
+
+namespace maseya::vkbase {
+namespace fs = std::filesystem;
+
+namespace {
+std::vector<char> read_pipeline_cache_file(VkPhysicalDevice physical_device,
+                                           const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return {};
+    }
+
+    std::vector<char> result((std::istreambuf_iterator<char>(file)),
+                             std::istreambuf_iterator<char>());
+
+    // Drivers are required to reject incompatible data, but not all of them do so
+    // gracefully, so compare the header against the current device first.
+    VkPipelineCacheHeaderVersionOne header;
+    if (result.size() < sizeof(header)) {
+        return {};
+    }
+    std::memcpy(&header, result.data(), sizeof(header));
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physical_device, &properties);
+
+    if (header.headerSize < sizeof(header) ||
+        header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+        header.vendorID != properties.vendorID ||
+        header.deviceID != properties.deviceID ||
+        std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID,
+                    VK_UUID_SIZE) != 0) {
+        return {};
+    }
+
+    return result;
+}
+}  // namespace
+
+PipelineCache::Destroyer::Destroyer(VkDevice device) noexcept : device(device) {}
+
+void PipelineCache::Destroyer::operator()(
+        VkPipelineCache pipeline_cache) const noexcept {
+    vkDestroyPipelineCache(device, pipeline_cache, nullptr);
+}
+
+PipelineCache::PipelineCache(VkDevice device)
+        : device_(device), cache_(create_pipeline_cache(device), device) {}
+
+PipelineCache::PipelineCache(VkDevice device, const std::vector<char>& initial_data)
+        : device_(device),
+          cache_(create_pipeline_cache(device, initial_data.data(),
+                                       initial_data.size()),
+                 device) {}
+
+PipelineCache::PipelineCache(VkDevice device, VkPhysicalDevice physical_device,
+                             const std::string& path)
+        : PipelineCache(device, read_pipeline_cache_file(physical_device, path)) {}
+
+std::vector<char> PipelineCache::data() const {
+    return get_pipeline_cache_data(device_, *cache_);
+}
+
+void PipelineCache::save(const std::string& path) const {
+    std::vector<char> cache_data = data();
+
+    // Write next to the destination and rename so that a crash mid-write cannot
+    // leave a truncated cache behind for the next session.
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw InvalidPathError("Could not open pipeline cache for writing.",
+                                   temp_path);
+        }
+        file.write(cache_data.data(), static_cast<std::streamsize>(cache_data.size()));
+        if (!file) {
+            throw InvalidPathError("Could not write pipeline cache.", temp_path);
+        }
+    }
+
+    fs::rename(temp_path, path);
+}
+}  // namespace maseya::vkbase
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vulkan/vulkan_core.h>
+
+#include <string>
+#include <vector>
+
+#include "UniqueObject.hxx"
+
+namespace maseya::vkbase {
+class PipelineCache {
+    struct Destroyer {
+        constexpr Destroyer() noexcept : device(nullptr) {}
+
+        Destroyer(VkDevice device) noexcept;
+
+        void operator()(VkPipelineCache pipeline_cache) const noexcept;
+
+        VkDevice device;
+    };
+
+public:
+    constexpr PipelineCache(std::nullptr_t) noexcept
+            : device_(nullptr), cache_(nullptr) {}
+
+    PipelineCache(VkDevice device);
+    PipelineCache(VkDevice device, const std::vector<char>& initial_data);
+
+    // Loads the cache saved by a previous session. A missing file, or data written by
+    // a different driver or physical device, silently yields an empty cache.
+    PipelineCache(VkDevice device, VkPhysicalDevice physical_device,
+                  const std::string& path);
+
+    VkPipelineCache operator*() const noexcept { return *cache_; }
+
+    explicit operator bool() const noexcept { return static_cast<bool>(cache_); }
+
+    std::vector<char> data() const;
+
+    void save(const std::string& path) const;
+
+private:
+    VkDevice device_;
+    UniqueObject<VkPipelineCache, Destroyer> cache_;
+};
+}  // namespace maseya::vkbase
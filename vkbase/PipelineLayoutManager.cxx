@@ -8,7 +8,7 @@ std::size_t PipelineLayoutManager::PipelineLayoutKey::Hasher::operator()(
         const PipelineLayoutKey& obj) const noexcept {
     std::size_t result = 0;
     hash_combine(result, obj.flags_);
-    hash_combine_invariant(result, obj.descriptor_sets_);
+    hash_combine(result, obj.descriptor_sets_);
     hash_combine_invariant(result, obj.push_constant_ranges_);
     return result;
 }
@@ -45,7 +45,7 @@ bool PipelineLayoutManager::PipelineLayoutKey::operator==(
 }
 
 PipelineLayoutManager::PipelineLayoutManager(VkDevice device)
-        : device_(device), pipeline_layouts_() {}
+        : device_(device), pipeline_layouts_(std::make_unique<PipelineLayoutCache>()) {}
 
 const PipelineLayout& PipelineLayoutManager::get_pipeline_layout(
         const VkDescriptorSetLayout* descriptor_set_layouts, std::uint32_t count) {
@@ -67,14 +67,8 @@ const PipelineLayout& PipelineLayoutManager::get_pipeline_layout(
 
 const PipelineLayout& PipelineLayoutManager::get_pipeline_layout(
         const VkPipelineLayoutCreateInfo& create_info) {
-    PipelineLayoutKey key(create_info);
-    auto it = pipeline_layouts_.find(key);
-    if (it != pipeline_layouts_.end()) {
-        return it->second;
-    }
-
-    auto it2 = pipeline_layouts_.insert(
-            {std::move(key), PipelineLayout(device_, create_info)});
-    return it2.first->second;
+    return pipeline_layouts_->get_or_create(
+            PipelineLayoutKey(create_info),
+            [this, &create_info]() { return PipelineLayout(device_, create_info); });
 }
 }  // namespace maseya::vkbase
\ No newline at end of file
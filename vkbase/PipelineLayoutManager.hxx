@@ -2,9 +2,11 @@
 
 #include <vulkan/vulkan_core.h>
 
-#include <unordered_map>
+#include <memory>
 #include <unordered_set>
+#include <vector>
 
+#include "ConcurrentCache.hxx"
 #include "PipelineLayout.hxx"
 
 namespace maseya::vkbase {
@@ -33,7 +35,8 @@ class PipelineLayoutManager {
 
     private:
         VkPipelineLayoutCreateFlags flags_;
-        std::unordered_set<VkDescriptorSetLayout> descriptor_sets_;
+        // Ordered, since a layout's position is its set number.
+        std::vector<VkDescriptorSetLayout> descriptor_sets_;
         std::unordered_set<VkPushConstantRange, PushConstantRangeHasher,
                            PushConstantRangeEq>
                 push_constant_ranges_;
@@ -41,6 +44,9 @@ class PipelineLayoutManager {
         friend class PipelineLayoutManager;
     };
 
+    using PipelineLayoutCache = ConcurrentCache<PipelineLayoutKey, PipelineLayout,
+                                                PipelineLayoutKey::Hasher>;
+
 public:
     PipelineLayoutManager(std::nullptr_t) noexcept
             : device_(nullptr), pipeline_layouts_() {}
@@ -53,6 +59,8 @@ public:
     PipelineLayoutManager& operator=(const PipelineLayoutManager&) = delete;
     PipelineLayoutManager& operator=(PipelineLayoutManager&&) noexcept = default;
 
+    // Safe to call from multiple threads. The returned reference stays valid for the
+    // lifetime of the manager.
     const PipelineLayout& get_pipeline_layout(
             const VkDescriptorSetLayout* descriptor_set_layouts, std::uint32_t count);
     const PipelineLayout& get_pipeline_layout(
@@ -70,7 +78,6 @@ public:
 
 private:
     VkDevice device_;
-    std::unordered_map<PipelineLayoutKey, PipelineLayout, PipelineLayoutKey::Hasher>
-            pipeline_layouts_;
+    std::unique_ptr<PipelineLayoutCache> pipeline_layouts_;
 };
 }  // namespace maseya::vkbase
\ No newline at end of file
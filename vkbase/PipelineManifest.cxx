@@ -0,0 +1,314 @@
+#include "PipelineManifest.hxx"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "ShaderModule.hxx"
+#include "VulkanError.hxx"
+
+namespace maseya::vkbase {
+namespace fs = std::filesystem;
+
+namespace {
+constexpr const char* manifest_header = "vkbase-pipeline-manifest 1";
+
+const PipelineShaderKey* find_shader(const PipelineKey& key, ShaderKind shader_kind) {
+    auto it = std::find_if(key.shaders.begin(), key.shaders.end(),
+                           [shader_kind](const PipelineShaderKey& shader) {
+                               return shader.shader_kind == shader_kind;
+                           });
+    return it != key.shaders.end() ? &*it : nullptr;
+}
+
+ShaderModule create_shader_module(VkDevice device, const Compiler& compiler,
+                                  const PipelineShaderKey& shader) {
+    return ShaderModule(device, compiler.compile_shader(shader.path, shader.shader_kind,
+                                                        shader.defines));
+}
+
+bool parse_hex_bytes(const std::string& hex, std::vector<std::byte>& bytes) {
+    if (hex.size() % 2 != 0) {
+        return false;
+    }
+
+    auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            return c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            return c - 'A' + 10;
+        } else {
+            return -1;
+        }
+    };
+
+    bytes.clear();
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        int high = nibble(hex[i]);
+        int low = nibble(hex[i + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        bytes.push_back(static_cast<std::byte>((high << 4) | low));
+    }
+
+    return true;
+}
+}  // namespace
+
+std::string serialize_pipeline_key(const PipelineKey& key) {
+    std::ostringstream ss;
+    ss << "pipeline " << static_cast<int>(key.bind_point) << ' '
+       << static_cast<int>(key.color_format) << ' '
+       << static_cast<int>(key.depth_format) << '\n';
+
+    for (const auto& shader : key.shaders) {
+        ss << "shader " << static_cast<int>(shader.shader_kind) << ' '
+           << std::quoted(shader.path) << '\n';
+        for (const auto& define : shader.defines) {
+            ss << "define " << std::quoted(define.name) << ' '
+               << std::quoted(define.value) << '\n';
+        }
+
+        const auto& data = shader.specialization_info.data();
+        for (const auto& entry : shader.specialization_info.map_entries()) {
+            ss << "constant " << entry.constantID << ' ' << std::hex
+               << std::setfill('0');
+            for (size_t i = 0; i < entry.size; i++) {
+                ss << std::setw(2) << std::to_integer<int>(data[entry.offset + i]);
+            }
+            ss << std::dec << std::setfill(' ') << '\n';
+        }
+    }
+
+    for (const auto& binding : key.descriptor_set_layout_bindings) {
+        ss << "binding " << binding.binding << ' '
+           << static_cast<int>(binding.descriptorType) << ' '
+           << binding.descriptorCount << ' ' << binding.stageFlags << '\n';
+    }
+
+    for (const auto& binding : key.vertex_binding_descriptions) {
+        ss << "vertex-binding " << binding.binding << ' ' << binding.stride << ' '
+           << static_cast<int>(binding.inputRate) << '\n';
+    }
+
+    for (const auto& attribute : key.vertex_attribute_descriptions) {
+        ss << "vertex-attribute " << attribute.location << ' ' << attribute.binding
+           << ' ' << static_cast<int>(attribute.format) << ' ' << attribute.offset
+           << '\n';
+    }
+
+    ss << "end\n";
+    return ss.str();
+}
+
+PipelineManifest::PipelineManifest() : mutex_(), keys_(), serialized_keys_() {}
+
+PipelineManifest::PipelineManifest(const std::string& path) : PipelineManifest() {
+    std::ifstream file(path);
+    if (!file) {
+        return;
+    }
+
+    std::string line;
+    if (!std::getline(file, line)) {
+        return;
+    }
+    if (line != manifest_header) {
+        throw InvalidPathError("Unrecognized pipeline manifest.", path);
+    }
+
+    auto fail = [&path]() {
+        throw InvalidPathError("Malformed pipeline manifest.", path);
+    };
+
+    PipelineKey key{};
+    bool in_pipeline = false;
+    while (std::getline(file, line)) {
+        std::istringstream ss(line);
+        std::string tag;
+        if (!(ss >> tag)) {
+            continue;
+        }
+
+        if (tag == "pipeline") {
+            if (in_pipeline) {
+                fail();
+            }
+
+            int bind_point, color_format, depth_format;
+            ss >> bind_point >> color_format >> depth_format;
+
+            key = PipelineKey{};
+            key.bind_point = static_cast<VkPipelineBindPoint>(bind_point);
+            key.color_format = static_cast<VkFormat>(color_format);
+            key.depth_format = static_cast<VkFormat>(depth_format);
+            in_pipeline = true;
+        } else if (!in_pipeline) {
+            fail();
+        } else if (tag == "shader") {
+            int shader_kind;
+            PipelineShaderKey shader{};
+            ss >> shader_kind >> std::quoted(shader.path);
+            shader.shader_kind = static_cast<ShaderKind>(shader_kind);
+            key.shaders.push_back(std::move(shader));
+        } else if (tag == "define") {
+            if (key.shaders.empty()) {
+                fail();
+            }
+
+            Define define;
+            ss >> std::quoted(define.name) >> std::quoted(define.value);
+            key.shaders.back().defines.push_back(std::move(define));
+        } else if (tag == "constant") {
+            uint32_t constant_id;
+            std::string hex;
+            std::vector<std::byte> bytes;
+            ss >> constant_id >> hex;
+            if (key.shaders.empty() || !parse_hex_bytes(hex, bytes)) {
+                fail();
+            }
+
+            key.shaders.back().specialization_info.add_constant(
+                    constant_id, bytes.data(), bytes.size());
+        } else if (tag == "binding") {
+            VkDescriptorSetLayoutBinding binding{};
+            int descriptor_type;
+            ss >> binding.binding >> descriptor_type >> binding.descriptorCount >>
+                    binding.stageFlags;
+            binding.descriptorType = static_cast<VkDescriptorType>(descriptor_type);
+            key.descriptor_set_layout_bindings.push_back(binding);
+        } else if (tag == "vertex-binding") {
+            VkVertexInputBindingDescription binding{};
+            int input_rate;
+            ss >> binding.binding >> binding.stride >> input_rate;
+            binding.inputRate = static_cast<VkVertexInputRate>(input_rate);
+            key.vertex_binding_descriptions.push_back(binding);
+        } else if (tag == "vertex-attribute") {
+            VkVertexInputAttributeDescription attribute{};
+            int format;
+            ss >> attribute.location >> attribute.binding >> format >> attribute.offset;
+            attribute.format = static_cast<VkFormat>(format);
+            key.vertex_attribute_descriptions.push_back(attribute);
+        } else if (tag == "end") {
+            record(key);
+            in_pipeline = false;
+        } else {
+            fail();
+        }
+
+        if (ss.fail()) {
+            fail();
+        }
+    }
+
+    if (in_pipeline) {
+        fail();
+    }
+}
+
+bool PipelineManifest::record(const PipelineKey& key) {
+    std::string serialized_key = serialize_pipeline_key(key);
+
+    std::lock_guard lock(mutex_);
+    if (!serialized_keys_.insert(std::move(serialized_key)).second) {
+        return false;
+    }
+
+    keys_.push_back(key);
+    return true;
+}
+
+Pipeline PipelineManifest::create_pipeline(VkDevice device,
+                                           const Compiler& compiler,
+                                           const PipelineKey& key,
+                                           VkRenderPass render_pass,
+                                           VkPipelineCache pipeline_cache) {
+    Pipeline result = create_pipeline_from_key(device, compiler, key, render_pass,
+                                               pipeline_cache);
+    record(key);
+    return result;
+}
+
+ComputePipeline PipelineManifest::create_compute_pipeline(
+        VkDevice device, const Compiler& compiler, const PipelineKey& key,
+        VkPipelineCache pipeline_cache) {
+    ComputePipeline result =
+            create_compute_pipeline_from_key(device, compiler, key, pipeline_cache);
+    record(key);
+    return result;
+}
+
+std::vector<PipelineKey> PipelineManifest::keys() const {
+    std::lock_guard lock(mutex_);
+    return keys_;
+}
+
+size_t PipelineManifest::size() const {
+    std::lock_guard lock(mutex_);
+    return keys_.size();
+}
+
+void PipelineManifest::save(const std::string& path) const {
+    std::vector<PipelineKey> keys = this->keys();
+
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::trunc);
+        if (!file) {
+            throw InvalidPathError("Could not open pipeline manifest for writing.",
+                                   temp_path);
+        }
+
+        file << manifest_header << '\n';
+        for (const auto& key : keys) {
+            file << serialize_pipeline_key(key);
+        }
+
+        if (!file) {
+            throw InvalidPathError("Could not write pipeline manifest.", temp_path);
+        }
+    }
+
+    fs::rename(temp_path, path);
+}
+
+Pipeline create_pipeline_from_key(VkDevice device, const Compiler& compiler,
+                                  const PipelineKey& key, VkRenderPass render_pass,
+                                  VkPipelineCache pipeline_cache) {
+    const auto* vertex_shader = find_shader(key, ShaderKind::VertexShader);
+    const auto* fragment_shader = find_shader(key, ShaderKind::FragmentShader);
+    if (key.bind_point != VK_PIPELINE_BIND_POINT_GRAPHICS || !vertex_shader ||
+        !fragment_shader) {
+        throw VkBaseError("Graphics pipeline key needs a vertex and fragment shader.");
+    }
+
+    ShaderModule vertex_module = create_shader_module(device, compiler, *vertex_shader);
+    ShaderModule fragment_module =
+            create_shader_module(device, compiler, *fragment_shader);
+    return Pipeline(device, render_pass, key.descriptor_set_layout_bindings,
+                    *vertex_module, vertex_shader->specialization_info,
+                    *fragment_module, fragment_shader->specialization_info,
+                    key.vertex_binding_descriptions, key.vertex_attribute_descriptions,
+                    pipeline_cache);
+}
+
+ComputePipeline create_compute_pipeline_from_key(VkDevice device,
+                                                 const Compiler& compiler,
+                                                 const PipelineKey& key,
+                                                 VkPipelineCache pipeline_cache) {
+    const auto* compute_shader = find_shader(key, ShaderKind::ComputeShader);
+    if (key.bind_point != VK_PIPELINE_BIND_POINT_COMPUTE || !compute_shader) {
+        throw VkBaseError("Compute pipeline key has no compute shader.");
+    }
+
+    ShaderModule shader_module =
+            create_shader_module(device, compiler, *compute_shader);
+    return ComputePipeline(device, key.descriptor_set_layout_bindings, *shader_module,
+                           compute_shader->specialization_info, pipeline_cache);
+}
+}  // namespace maseya::vkbase
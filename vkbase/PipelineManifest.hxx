@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vulkan/vulkan_core.h>
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "Compiler.hxx"
+#include "ComputePipeline.hxx"
+#include "Pipeline.hxx"
+#include "SpecializationInfo.hxx"
+
+namespace maseya::vkbase {
+struct PipelineShaderKey {
+    std::string path;
+    ShaderKind shader_kind;
+    std::vector<Define> defines;
+    SpecializationInfo specialization_info;
+};
+
+// Everything needed to recreate a pipeline from scratch, apart from its render pass.
+// Graphics pipelines expect a vertex and a fragment shader, and the formats tell
+// which of the application's render passes they are used with. Immutable samplers
+// cannot be recorded and are dropped.
+struct PipelineKey {
+    VkPipelineBindPoint bind_point;
+    std::vector<PipelineShaderKey> shaders;
+    VkFormat color_format;
+    VkFormat depth_format;
+    std::vector<VkDescriptorSetLayoutBinding> descriptor_set_layout_bindings;
+    std::vector<VkVertexInputBindingDescription> vertex_binding_descriptions;
+    std::vector<VkVertexInputAttributeDescription> vertex_attribute_descriptions;
+};
+
+std::string serialize_pipeline_key(const PipelineKey& key);
+
+// Compiles the key's shaders and creates the graphics pipeline it describes. The
+// render pass must be the one the pipeline is used with, or compatible with it, for
+// the driver's pipeline cache to match.
+Pipeline create_pipeline_from_key(VkDevice device, const Compiler& compiler,
+                                  const PipelineKey& key, VkRenderPass render_pass,
+                                  VkPipelineCache pipeline_cache = VK_NULL_HANDLE);
+
+ComputePipeline create_compute_pipeline_from_key(
+        VkDevice device, const Compiler& compiler, const PipelineKey& key,
+        VkPipelineCache pipeline_cache = VK_NULL_HANDLE);
+
+// Collects the keys of the pipelines created during a run so that the next launch can
+// build them all up front. Pipeline and ComputePipeline only ever see shader modules,
+// not the shader paths and defines they came from, so they record nothing on their
+// own. Pipelines created through the manifest's create functions are recorded as
+// they are created; for any other pipeline, call record() with its key next to where
+// it is created. Recording is thread safe and ignores keys that were already seen.
+class PipelineManifest {
+public:
+    PipelineManifest();
+
+    // Loads a saved manifest. A missing file yields an empty manifest.
+    explicit PipelineManifest(const std::string& path);
+
+    PipelineManifest(const PipelineManifest&) = delete;
+    PipelineManifest& operator=(const PipelineManifest&) = delete;
+
+    // Returns false if an identical key was already recorded.
+    bool record(const PipelineKey& key);
+
+    // Creates the pipeline with create_pipeline_from_key() and records its key.
+    Pipeline create_pipeline(VkDevice device, const Compiler& compiler,
+                             const PipelineKey& key, VkRenderPass render_pass,
+                             VkPipelineCache pipeline_cache = VK_NULL_HANDLE);
+
+    // Creates the pipeline with create_compute_pipeline_from_key() and records its key.
+    ComputePipeline create_compute_pipeline(
+            VkDevice device, const Compiler& compiler, const PipelineKey& key,
+            VkPipelineCache pipeline_cache = VK_NULL_HANDLE);
+
+    std::vector<PipelineKey> keys() const;
+
+    size_t size() const;
+
+    void save(const std::string& path) const;
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<PipelineKey> keys_;
+    std::unordered_set<std::string> serialized_keys_;
+};
+}  // namespace maseya::vkbase
@@ -0,0 +1,265 @@
+#include "PipelineReport.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+
+#include "VulkanError.hxx"
+#include "vulkan_helper.hxx"
+
+namespace maseya::vkbase {
+namespace {
+std::mutex registry_mutex;
+std::unordered_map<VkDevice, PipelineReport*> registry;
+std::atomic<size_t> registry_size(0);
+
+thread_local std::string current_label;
+
+bool is_valid(const VkPipelineCreationFeedbackEXT& feedback) noexcept {
+    return (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT_EXT) != 0;
+}
+
+bool is_cache_hit(const VkPipelineCreationFeedbackEXT& feedback) noexcept {
+    return (feedback.flags &
+            VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT) != 0;
+}
+
+PipelineExecutableStatistic get_statistic(
+        const VkPipelineExecutableStatisticKHR& statistic) {
+    PipelineExecutableStatistic result;
+    result.name = statistic.name;
+    result.description = statistic.description;
+
+    switch (statistic.format) {
+        case VK_PIPELINE_EXECUTABLE_STATISTIC_FORMAT_BOOL32_KHR:
+            result.value = statistic.value.b32 != VK_FALSE;
+            break;
+        case VK_PIPELINE_EXECUTABLE_STATISTIC_FORMAT_INT64_KHR:
+            result.value = statistic.value.i64;
+            break;
+        case VK_PIPELINE_EXECUTABLE_STATISTIC_FORMAT_UINT64_KHR:
+            result.value = statistic.value.u64;
+            break;
+        case VK_PIPELINE_EXECUTABLE_STATISTIC_FORMAT_FLOAT64_KHR:
+            result.value = statistic.value.f64;
+            break;
+        default:
+            break;
+    }
+
+    return result;
+}
+}  // namespace
+
+PipelineReport::PipelineReport(VkDevice device, bool creation_feedback_enabled,
+                               bool executable_statistics_enabled)
+        : device_(device),
+          creation_feedback_enabled_(creation_feedback_enabled),
+          executable_statistics_enabled_(executable_statistics_enabled),
+          get_executable_properties_(nullptr),
+          get_executable_statistics_(nullptr),
+          visitor_mutex_(),
+          mutex_(),
+          entries_() {
+    if (executable_statistics_enabled_) {
+        get_executable_properties_ =
+                GET_DEVICE_PROC_ADDR(device, vkGetPipelineExecutablePropertiesKHR);
+        get_executable_statistics_ =
+                GET_DEVICE_PROC_ADDR(device, vkGetPipelineExecutableStatisticsKHR);
+    }
+
+    std::lock_guard lock(registry_mutex);
+    if (!registry.emplace(device, this).second) {
+        throw VkBaseError("A pipeline report is already registered for this device.");
+    }
+    registry_size++;
+}
+
+PipelineReport::~PipelineReport() {
+    {
+        std::lock_guard lock(registry_mutex);
+        registry.erase(device_);
+        registry_size--;
+    }
+
+    // No visitor can find the report anymore, so wait for the ones that already did.
+    std::unique_lock lock(visitor_mutex_);
+}
+
+std::vector<PipelineReportEntry> PipelineReport::entries() const {
+    std::lock_guard lock(mutex_);
+    return entries_;
+}
+
+std::vector<PipelineReportEntry> PipelineReport::cache_misses() const {
+    std::lock_guard lock(mutex_);
+
+    std::vector<PipelineReportEntry> result;
+    std::copy_if(entries_.begin(), entries_.end(), std::back_inserter(result),
+                 [](const PipelineReportEntry& entry) {
+                     return entry.feedback_valid && !entry.cache_hit;
+                 });
+
+    return result;
+}
+
+void PipelineReport::clear() {
+    std::lock_guard lock(mutex_);
+    entries_.clear();
+}
+
+PipelineReport::ScopedLabel::ScopedLabel(std::string label)
+        : previous_label_(std::exchange(current_label, std::move(label))) {}
+
+PipelineReport::ScopedLabel::~ScopedLabel() {
+    current_label = std::move(previous_label_);
+}
+
+bool PipelineReport::visit(
+        VkDevice device, const std::function<void(PipelineReport& report)>& function) {
+    // Keep pipeline creation free of locking when instrumentation is not in use.
+    if (registry_size == 0) {
+        return false;
+    }
+
+    // The destructor unregisters under the registry lock before waiting for visitors,
+    // so a report found under it is kept alive by its visitor lock alone.
+    PipelineReport* report;
+    std::shared_lock<std::shared_mutex> visitor_lock;
+    {
+        std::lock_guard lock(registry_mutex);
+        auto it = registry.find(device);
+        if (it == registry.end()) {
+            return false;
+        }
+
+        report = it->second;
+        visitor_lock = std::shared_lock(report->visitor_mutex_);
+    }
+
+    function(*report);
+    return true;
+}
+
+void PipelineReport::record(VkPipeline pipeline, VkPipelineBindPoint bind_point,
+                            const VkPipelineCreationFeedbackEXT& feedback,
+                            const VkPipelineShaderStageCreateInfo* stages,
+                            const VkPipelineCreationFeedbackEXT* stage_feedbacks,
+                            uint32_t stage_count) {
+    PipelineReportEntry entry{};
+    entry.label = current_label;
+    entry.bind_point = bind_point;
+    entry.feedback_valid = is_valid(feedback);
+    entry.cache_hit = is_cache_hit(feedback);
+    entry.duration = std::chrono::nanoseconds(feedback.duration);
+
+    for (uint32_t i = 0; i < stage_count; i++) {
+        PipelineStageFeedback stage{};
+        stage.stage = stages[i].stage;
+        stage.valid = is_valid(stage_feedbacks[i]);
+        stage.cache_hit = is_cache_hit(stage_feedbacks[i]);
+        stage.duration = std::chrono::nanoseconds(stage_feedbacks[i].duration);
+        entry.stages.push_back(stage);
+    }
+
+    if (executable_statistics_enabled_) {
+        // Statistics are purely diagnostic and must never fail pipeline creation.
+        try {
+            entry.executables = get_executables(pipeline);
+        } catch (const VkBaseError&) {
+        }
+    }
+
+    std::lock_guard lock(mutex_);
+    entries_.push_back(std::move(entry));
+}
+
+std::vector<PipelineExecutableReport> PipelineReport::get_executables(
+        VkPipeline pipeline) const {
+    VkPipelineInfoKHR pipeline_info{};
+    pipeline_info.sType = VK_STRUCTURE_TYPE_PIPELINE_INFO_KHR;
+    pipeline_info.pipeline = pipeline;
+
+    uint32_t count;
+    assert_result(get_executable_properties_(device_, &pipeline_info, &count, nullptr));
+
+    VkPipelineExecutablePropertiesKHR empty_properties{};
+    empty_properties.sType = VK_STRUCTURE_TYPE_PIPELINE_EXECUTABLE_PROPERTIES_KHR;
+
+    std::vector<VkPipelineExecutablePropertiesKHR> properties(count, empty_properties);
+    assert_result(get_executable_properties_(device_, &pipeline_info, &count,
+                                             properties.data()));
+
+    std::vector<PipelineExecutableReport> result(count);
+    for (uint32_t i = 0; i < count; i++) {
+        result[i].name = properties[i].name;
+        result[i].description = properties[i].description;
+        result[i].stages = properties[i].stages;
+        result[i].subgroup_size = properties[i].subgroupSize;
+
+        VkPipelineExecutableInfoKHR executable_info{};
+        executable_info.sType = VK_STRUCTURE_TYPE_PIPELINE_EXECUTABLE_INFO_KHR;
+        executable_info.pipeline = pipeline;
+        executable_info.executableIndex = i;
+
+        uint32_t statistic_count;
+        assert_result(get_executable_statistics_(device_, &executable_info,
+                                                 &statistic_count, nullptr));
+
+        VkPipelineExecutableStatisticKHR empty_statistic{};
+        empty_statistic.sType = VK_STRUCTURE_TYPE_PIPELINE_EXECUTABLE_STATISTIC_KHR;
+
+        std::vector<VkPipelineExecutableStatisticKHR> statistics(statistic_count,
+                                                                 empty_statistic);
+        assert_result(get_executable_statistics_(device_, &executable_info,
+                                                 &statistic_count, statistics.data()));
+
+        for (const auto& statistic : statistics) {
+            result[i].statistics.push_back(get_statistic(statistic));
+        }
+    }
+
+    return result;
+}
+
+PipelineFeedbackRecorder::PipelineFeedbackRecorder(
+        VkDevice device, const VkPipelineShaderStageCreateInfo* stages,
+        uint32_t stage_count)
+        : device_(device),
+          report_found_(false),
+          creation_feedback_enabled_(false),
+          executable_statistics_enabled_(false),
+          stages_(stages),
+          stage_count_(stage_count),
+          feedback_{},
+          stage_feedbacks_(),
+          feedback_info_{} {
+    report_found_ = PipelineReport::visit(device, [this](PipelineReport& report) {
+        creation_feedback_enabled_ = report.creation_feedback_enabled();
+        executable_statistics_enabled_ = report.executable_statistics_enabled();
+    });
+    if (report_found_) {
+        stage_feedbacks_.resize(stage_count);
+    }
+
+    feedback_info_.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT;
+    feedback_info_.pPipelineCreationFeedback = &feedback_;
+    feedback_info_.pipelineStageCreationFeedbackCount =
+            static_cast<uint32_t>(stage_feedbacks_.size());
+    feedback_info_.pPipelineStageCreationFeedbacks = stage_feedbacks_.data();
+}
+
+void PipelineFeedbackRecorder::record(VkPipeline pipeline,
+                                      VkPipelineBindPoint bind_point) {
+    if (!report_found_) {
+        return;
+    }
+
+    PipelineReport::visit(device_, [&](PipelineReport& report) {
+        report.record(pipeline, bind_point, feedback_, stages_, stage_feedbacks_.data(),
+                      stage_count_);
+    });
+}
+}  // namespace maseya::vkbase
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <vulkan/vulkan_core.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace maseya::vkbase {
+struct PipelineStageFeedback {
+    VkShaderStageFlagBits stage;
+    bool valid;
+    bool cache_hit;
+    std::chrono::nanoseconds duration;
+};
+
+struct PipelineExecutableStatistic {
+    std::string name;
+    std::string description;
+    std::variant<bool, int64_t, uint64_t, double> value;
+};
+
+// A pipeline may be compiled into several executables, e.g. one per shader stage.
+struct PipelineExecutableReport {
+    std::string name;
+    std::string description;
+    VkShaderStageFlags stages;
+    uint32_t subgroup_size;
+    std::vector<PipelineExecutableStatistic> statistics;
+};
+
+struct PipelineReportEntry {
+    std::string label;
+    VkPipelineBindPoint bind_point;
+
+    // False if the driver did not provide creation feedback for this pipeline.
+    bool feedback_valid;
+    bool cache_hit;
+    std::chrono::nanoseconds duration;
+    std::vector<PipelineStageFeedback> stages;
+
+    std::vector<PipelineExecutableReport> executables;
+};
+
+// Collects VK_EXT_pipeline_creation_feedback and VK_KHR_pipeline_executable_properties
+// data for every pipeline created on a device while the report is alive. The device
+// must have been created with the corresponding extensions enabled.
+class PipelineReport {
+public:
+    PipelineReport(VkDevice device, bool creation_feedback_enabled,
+                   bool executable_statistics_enabled);
+
+    PipelineReport(const PipelineReport&) = delete;
+    PipelineReport& operator=(const PipelineReport&) = delete;
+
+    ~PipelineReport();
+
+    bool creation_feedback_enabled() const noexcept {
+        return creation_feedback_enabled_;
+    }
+
+    bool executable_statistics_enabled() const noexcept {
+        return executable_statistics_enabled_;
+    }
+
+    std::vector<PipelineReportEntry> entries() const;
+
+    // Pipelines whose creation feedback reports that the pipeline cache was missed.
+    std::vector<PipelineReportEntry> cache_misses() const;
+
+    void clear();
+
+    // Names the pipelines created on the current thread while it is alive, e.g. with
+    // the shader paths they were built from.
+    class ScopedLabel {
+    public:
+        explicit ScopedLabel(std::string label);
+
+        ScopedLabel(const ScopedLabel&) = delete;
+        ScopedLabel& operator=(const ScopedLabel&) = delete;
+
+        ~ScopedLabel();
+
+    private:
+        std::string previous_label_;
+    };
+
+    // Calls the function with the report registered for the device and returns true,
+    // or returns false if there is none. The report cannot be destroyed until the
+    // function returns, but no global lock is held while it runs, so pipelines can be
+    // recorded from several threads at once.
+    static bool visit(VkDevice device,
+                      const std::function<void(PipelineReport& report)>& function);
+
+    void record(VkPipeline pipeline, VkPipelineBindPoint bind_point,
+                const VkPipelineCreationFeedbackEXT& feedback,
+                const VkPipelineShaderStageCreateInfo* stages,
+                const VkPipelineCreationFeedbackEXT* stage_feedbacks,
+                uint32_t stage_count);
+
+private:
+    std::vector<PipelineExecutableReport> get_executables(VkPipeline pipeline) const;
+
+private:
+    VkDevice device_;
+    bool creation_feedback_enabled_;
+    bool executable_statistics_enabled_;
+
+    PFN_vkGetPipelineExecutablePropertiesKHR get_executable_properties_;
+    PFN_vkGetPipelineExecutableStatisticsKHR get_executable_statistics_;
+
+    // Shared by visitors, and taken exclusively by the destructor to wait for them.
+    std::shared_mutex visitor_mutex_;
+
+    mutable std::mutex mutex_;
+    std::vector<PipelineReportEntry> entries_;
+};
+
+// Chains creation feedback into a pipeline create info and hands the results to the
+// device's PipelineReport once the pipeline exists. Does nothing if no report is
+// registered for the device.
+class PipelineFeedbackRecorder {
+public:
+    PipelineFeedbackRecorder(VkDevice device,
+                             const VkPipelineShaderStageCreateInfo* stages,
+                             uint32_t stage_count);
+
+    PipelineFeedbackRecorder(const PipelineFeedbackRecorder&) = delete;
+    PipelineFeedbackRecorder& operator=(const PipelineFeedbackRecorder&) = delete;
+
+    template <class PipelineCreateInfo>
+    void attach(PipelineCreateInfo& create_info) noexcept {
+        if (creation_feedback_enabled_) {
+            feedback_info_.pNext = create_info.pNext;
+            create_info.pNext = &feedback_info_;
+        }
+
+        if (executable_statistics_enabled_) {
+            create_info.flags |= VK_PIPELINE_CREATE_CAPTURE_STATISTICS_BIT_KHR;
+        }
+    }
+
+    void record(VkPipeline pipeline, VkPipelineBindPoint bind_point);
+
+private:
+    // The report is looked up again when recording, as it may have been destroyed
+    // while the pipeline was being created.
+    VkDevice device_;
+    bool report_found_;
+    bool creation_feedback_enabled_;
+    bool executable_statistics_enabled_;
+    const VkPipelineShaderStageCreateInfo* stages_;
+    uint32_t stage_count_;
+    VkPipelineCreationFeedbackEXT feedback_;
+    std::vector<VkPipelineCreationFeedbackEXT> stage_feedbacks_;
+    VkPipelineCreationFeedbackCreateInfoEXT feedback_info_;
+};
+}  // namespace maseya::vkbase
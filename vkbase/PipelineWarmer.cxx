@@ -0,0 +1,114 @@
+#include "PipelineWarmer.hxx"
+
+#include <algorithm>
+#include <utility>
+
+#include "PipelineReport.hxx"
+#include "VulkanError.hxx"
+
+namespace maseya::vkbase {
+PipelineWarmer::PipelineWarmer(VkDevice device, VkPipelineCache pipeline_cache,
+                               std::vector<PipelineKey> keys,
+                               RenderPassSelector select_render_pass,
+                               unsigned thread_count)
+        : device_(device),
+          pipeline_cache_(pipeline_cache),
+          keys_(std::move(keys)),
+          select_render_pass_(std::move(select_render_pass)),
+          start_time_(std::chrono::steady_clock::now()),
+          next_key_index_(0),
+          failed_pipeline_count_(0),
+          running_thread_count_(0),
+          finish_mutex_(),
+          finish_time_(start_time_),
+          report_{},
+          threads_() {
+    if (thread_count == 0) {
+        thread_count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    }
+    thread_count = static_cast<unsigned>(
+            std::min(static_cast<size_t>(thread_count), keys_.size()));
+
+    running_thread_count_ = thread_count;
+    threads_.reserve(thread_count);
+    for (unsigned i = 0; i < thread_count; i++) {
+        threads_.emplace_back(&PipelineWarmer::run, this);
+    }
+}
+
+PipelineWarmer::PipelineWarmer(VkDevice device, VkPipelineCache pipeline_cache,
+                               std::vector<PipelineKey> keys, VkRenderPass render_pass,
+                               unsigned thread_count)
+        : PipelineWarmer(
+                  device, pipeline_cache, std::move(keys),
+                  [render_pass](const PipelineKey&) { return render_pass; },
+                  thread_count) {}
+
+PipelineWarmer::~PipelineWarmer() {
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+bool PipelineWarmer::done() const noexcept { return running_thread_count_ == 0; }
+
+const PipelineWarmupReport& PipelineWarmer::wait() {
+    auto wait_start = std::chrono::steady_clock::now();
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    auto wait_end = std::chrono::steady_clock::now();
+
+    report_.pipeline_count = keys_.size();
+    report_.failed_pipeline_count = failed_pipeline_count_;
+    report_.background_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            finish_time_ - start_time_);
+    report_.critical_path_time +=
+            std::chrono::duration_cast<std::chrono::nanoseconds>(wait_end - wait_start);
+    return report_;
+}
+
+void PipelineWarmer::run() {
+    // Each worker owns its compiler so that shader compilation does not serialize.
+    Compiler compiler;
+    for (size_t i = next_key_index_++; i < keys_.size(); i = next_key_index_++) {
+        try {
+            warm_up(compiler, keys_[i]);
+        } catch (const std::exception&) {
+            // A stale manifest may reference shaders that no longer exist. These are
+            // simply built on first use instead.
+            failed_pipeline_count_++;
+        }
+    }
+
+    {
+        std::lock_guard lock(finish_mutex_);
+        finish_time_ = std::max(finish_time_, std::chrono::steady_clock::now());
+    }
+    running_thread_count_--;
+}
+
+void PipelineWarmer::warm_up(const Compiler& compiler, const PipelineKey& key) const {
+    std::string label;
+    for (const auto& shader : key.shaders) {
+        label += label.empty() ? shader.path : ", " + shader.path;
+    }
+    PipelineReport::ScopedLabel scoped_label(std::move(label));
+
+    if (key.bind_point == VK_PIPELINE_BIND_POINT_COMPUTE) {
+        create_compute_pipeline_from_key(device_, compiler, key, pipeline_cache_);
+        return;
+    }
+
+    VkRenderPass render_pass = select_render_pass_(key);
+    if (render_pass == VK_NULL_HANDLE) {
+        throw VkBaseError("No render pass for graphics pipeline key.");
+    }
+
+    create_pipeline_from_key(device_, compiler, key, render_pass, pipeline_cache_);
+}
+}  // namespace maseya::vkbase
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vulkan/vulkan_core.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "PipelineManifest.hxx"
+
+namespace maseya::vkbase {
+struct PipelineWarmupReport {
+    size_t pipeline_count;
+    size_t failed_pipeline_count;
+
+    // Wall time from the construction of the warmer until its last pipeline was
+    // built.
+    std::chrono::nanoseconds background_time;
+
+    // Time spent blocked in PipelineWarmer::wait(), summed over every call. This is
+    // only how long waiting for the warm-up delayed the caller. A pipeline that the
+    // application created itself before the warm-up got to it was compiled on the
+    // application's thread instead, which is not counted here; PipelineReport's cache
+    // misses show those.
+    std::chrono::nanoseconds critical_path_time;
+};
+
+// Builds every pipeline in a manifest on background threads so that the driver
+// compiles them into the pipeline cache before they are first used. The pipelines
+// themselves are discarded; only the cache entries are kept. Graphics pipelines are
+// built against the application's own render passes, since a pipeline built against
+// an incompatible render pass may not match in the cache.
+class PipelineWarmer {
+public:
+    // Returns the render pass that the key's graphics pipeline is used with, or one
+    // compatible with it. Called from the warm-up threads.
+    using RenderPassSelector = std::function<VkRenderPass(const PipelineKey& key)>;
+
+    // A thread count of zero uses one thread per hardware thread, less one for the
+    // calling thread.
+    PipelineWarmer(VkDevice device, VkPipelineCache pipeline_cache,
+                   std::vector<PipelineKey> keys, RenderPassSelector select_render_pass,
+                   unsigned thread_count = 0);
+
+    // Builds every graphics pipeline against the same render pass.
+    PipelineWarmer(VkDevice device, VkPipelineCache pipeline_cache,
+                   std::vector<PipelineKey> keys, VkRenderPass render_pass,
+                   unsigned thread_count = 0);
+
+    PipelineWarmer(const PipelineWarmer&) = delete;
+    PipelineWarmer& operator=(const PipelineWarmer&) = delete;
+
+    ~PipelineWarmer();
+
+    bool done() const noexcept;
+
+    // Blocks until every pipeline has been built. Must not be called concurrently.
+    const PipelineWarmupReport& wait();
+
+private:
+    void run();
+
+    void warm_up(const Compiler& compiler, const PipelineKey& key) const;
+
+private:
+    VkDevice device_;
+    VkPipelineCache pipeline_cache_;
+    std::vector<PipelineKey> keys_;
+    RenderPassSelector select_render_pass_;
+    std::chrono::steady_clock::time_point start_time_;
+
+    std::atomic<size_t> next_key_index_;
+    std::atomic<size_t> failed_pipeline_count_;
+    std::atomic<size_t> running_thread_count_;
+
+    std::mutex finish_mutex_;
+    std::chrono::steady_clock::time_point finish_time_;
+
+    PipelineWarmupReport report_;
+    std::vector<std::thread> threads_;
+};
+}  // namespace maseya::vkbase
@@ -21,6 +21,13 @@ Sampler::Sampler(VkDevice device, VkFilter mag_filter, VkFilter min_filter,
         : sampler_(create_sampler(device, mag_filter, min_filter, address_mode),
                    device) {}
 
+Sampler::Sampler(VkDevice device, VkFilter mag_filter, VkFilter min_filter,
+                 VkSamplerMipmapMode mipmap_mode, VkSamplerAddressMode address_mode,
+                 float max_lod)
+        : sampler_(create_sampler(device, mag_filter, min_filter, mipmap_mode,
+                                  address_mode, max_lod),
+                   device) {}
+
 Sampler::Sampler(VkDevice device, VkSamplerAddressMode address_mode)
         : sampler_(create_sampler(device, address_mode), device) {}
 
@@ -25,6 +25,9 @@ public:
     Sampler(VkDevice device, VkFilter mag_filter, VkFilter min_filter,
             VkSamplerAddressMode address_mode =
                     VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER);
+    Sampler(VkDevice device, VkFilter mag_filter, VkFilter min_filter,
+            VkSamplerMipmapMode mipmap_mode, VkSamplerAddressMode address_mode,
+            float max_lod = VK_LOD_CLAMP_NONE);
     Sampler(VkDevice device, VkSamplerAddressMode address_mode);
     Sampler(VkDevice device);
 
@@ -0,0 +1,199 @@
+#include "ShaderArchive.hxx"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+#include "VulkanError.hxx"
+#include "math_helper.hxx"
+
+namespace maseya::vkbase {
+namespace fs = std::filesystem;
+
+namespace {
+// The archive is a header, an open addressing table of slots, the keys, and then
+// the SPIR-V blobs, each aligned to four bytes. Offsets are from the start of the
+// file, and all values are little endian.
+constexpr uint32_t archive_magic = 0x41534B56;
+constexpr uint32_t archive_version = 1;
+
+struct ArchiveHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t slot_count;
+};
+
+// A slot with a code size of zero is empty.
+struct ArchiveSlot {
+    uint64_t key_hash;
+    uint32_t key_offset;
+    uint32_t key_size;
+    uint32_t code_offset;
+    uint32_t code_size;
+};
+
+uint64_t get_key_hash(const std::string& key) noexcept {
+    return fnv1a_64(key.data(), key.size());
+}
+}  // namespace
+
+ShaderArchive::ShaderArchive(const std::string& path)
+        : file_(path, MappedFileHint::Random),
+          entry_count_(0),
+          slot_count_(0) {
+    ArchiveHeader header;
+    if (file_.size() < sizeof(header)) {
+        throw InvalidPathError("Not a shader archive.", path);
+    }
+
+    std::memcpy(&header, file_.data(), sizeof(header));
+    if (header.magic != archive_magic || header.version != archive_version ||
+        header.slot_count == 0 || (header.slot_count & (header.slot_count - 1)) ||
+        (file_.size() - sizeof(header)) / sizeof(ArchiveSlot) < header.slot_count) {
+        throw InvalidPathError("Not a shader archive.", path);
+    }
+
+    entry_count_ = header.entry_count;
+    slot_count_ = header.slot_count;
+}
+
+std::optional<ShaderArchiveEntry> ShaderArchive::find(
+        const std::string& key) const noexcept {
+    const std::byte* data = file_.data();
+    const auto* slots =
+            reinterpret_cast<const ArchiveSlot*>(data + sizeof(ArchiveHeader));
+
+    uint64_t key_hash = get_key_hash(key);
+    size_t mask = slot_count_ - 1;
+    for (size_t i = key_hash & mask, probes = 0; probes < slot_count_;
+         i = (i + 1) & mask, probes++) {
+        const ArchiveSlot& slot = slots[i];
+        if (slot.code_size == 0) {
+            break;
+        }
+
+        // Bounds are checked here rather than up front so that opening an archive
+        // does not touch every page of it.
+        if (slot.key_hash != key_hash || slot.key_size != key.size() ||
+            size_t(slot.key_offset) + slot.key_size > file_.size() ||
+            std::memcmp(data + slot.key_offset, key.data(), key.size()) != 0) {
+            continue;
+        }
+
+        if (slot.code_offset % sizeof(uint32_t) != 0 ||
+            size_t(slot.code_offset) + slot.code_size > file_.size()) {
+            break;
+        }
+
+        return ShaderArchiveEntry{
+                reinterpret_cast<const uint32_t*>(data + slot.code_offset),
+                slot.code_size};
+    }
+
+    return std::nullopt;
+}
+
+ShaderModule ShaderArchive::create_shader_module(VkDevice device,
+                                                 const std::string& key) const {
+    std::optional<ShaderArchiveEntry> entry = find(key);
+    if (!entry) {
+        throw VkBaseError("Shader archive has no entry \"" + key + "\".");
+    }
+
+    return ShaderModule(device, entry->code, entry->size);
+}
+
+void ShaderArchiveWriter::add(const std::string& key,
+                              std::vector<uint32_t> spirv_code) {
+    if (spirv_code.empty()) {
+        throw VkBaseError("Cannot add empty SPIR-V to a shader archive.");
+    }
+
+    auto it = std::find_if(entries_.begin(), entries_.end(),
+                           [&key](const Entry& entry) { return entry.key == key; });
+    if (it != entries_.end()) {
+        it->spirv_code = std::move(spirv_code);
+    } else {
+        entries_.push_back({key, std::move(spirv_code)});
+    }
+}
+
+void ShaderArchiveWriter::save(const std::string& path) const {
+    // Keep the table at most half full so that misses end quickly.
+    uint32_t slot_count = 1;
+    while (slot_count < entries_.size() * 2) {
+        slot_count *= 2;
+    }
+
+    std::vector<ArchiveSlot> slots(slot_count, ArchiveSlot{});
+    std::vector<char> keys;
+    size_t keys_offset = sizeof(ArchiveHeader) + slot_count * sizeof(ArchiveSlot);
+    size_t code_offset = keys_offset;
+    for (const auto& entry : entries_) {
+        code_offset += entry.key.size();
+    }
+    code_offset = (code_offset + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1);
+
+    for (const auto& entry : entries_) {
+        size_t code_size = entry.spirv_code.size() * sizeof(uint32_t);
+        if (code_offset + code_size > std::numeric_limits<uint32_t>::max()) {
+            throw InvalidPathError("Shader archive is too large.", path);
+        }
+
+        ArchiveSlot slot{};
+        slot.key_hash = get_key_hash(entry.key);
+        slot.key_offset = static_cast<uint32_t>(keys_offset + keys.size());
+        slot.key_size = static_cast<uint32_t>(entry.key.size());
+        slot.code_offset = static_cast<uint32_t>(code_offset);
+        slot.code_size = static_cast<uint32_t>(code_size);
+
+        size_t i = slot.key_hash & (slot_count - 1);
+        while (slots[i].code_size != 0) {
+            i = (i + 1) & (slot_count - 1);
+        }
+        slots[i] = slot;
+
+        keys.insert(keys.end(), entry.key.begin(), entry.key.end());
+        code_offset += code_size;
+    }
+
+    ArchiveHeader header{archive_magic, archive_version,
+                         static_cast<uint32_t>(entries_.size()), slot_count};
+
+    // Write next to the destination and rename so that a crash mid-write cannot
+    // leave a truncated archive behind.
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw InvalidPathError("Could not open shader archive for writing.",
+                                   temp_path);
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(slots.data()),
+                   static_cast<std::streamsize>(slots.size() * sizeof(ArchiveSlot)));
+        file.write(keys.data(), static_cast<std::streamsize>(keys.size()));
+
+        static constexpr char padding[sizeof(uint32_t)] = {};
+        size_t written = keys_offset + keys.size();
+        file.write(padding, static_cast<std::streamsize>(
+                                    (sizeof(uint32_t) - written % sizeof(uint32_t)) %
+                                    sizeof(uint32_t)));
+        for (const auto& entry : entries_) {
+            file.write(reinterpret_cast<const char*>(entry.spirv_code.data()),
+                       static_cast<std::streamsize>(entry.spirv_code.size() *
+                                                    sizeof(uint32_t)));
+        }
+
+        if (!file) {
+            throw InvalidPathError("Could not write shader archive.", temp_path);
+        }
+    }
+
+    fs::rename(temp_path, path);
+}
+}  // namespace maseya::vkbase
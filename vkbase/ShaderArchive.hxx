@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vulkan/vulkan_core.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "MappedFile.hxx"
+#include "ShaderModule.hxx"
+
+namespace maseya::vkbase {
+struct ShaderArchiveEntry {
+    const uint32_t* code;
+
+    // In bytes, as passed to vkCreateShaderModule.
+    size_t size;
+};
+
+// A read-only bundle of precompiled SPIR-V, looked up by key. The archive is mapped
+// into memory rather than read, and entries point straight into the mapping, so
+// creating a shader module from one copies nothing.
+//
+// Archives are written by ShaderArchiveWriter, usually through the shader_archiver
+// tool, so applications that load them do not need shaderc.
+class ShaderArchive {
+public:
+    explicit ShaderArchive(const std::string& path);
+
+    ShaderArchive(const ShaderArchive&) = delete;
+    ShaderArchive(ShaderArchive&&) noexcept = default;
+
+    ShaderArchive& operator=(const ShaderArchive&) = delete;
+    ShaderArchive& operator=(ShaderArchive&&) noexcept = default;
+
+    // The entry stays valid for the lifetime of the archive.
+    std::optional<ShaderArchiveEntry> find(const std::string& key) const noexcept;
+
+    ShaderModule create_shader_module(VkDevice device, const std::string& key) const;
+
+    size_t size() const noexcept { return entry_count_; }
+
+private:
+    MappedFile file_;
+    size_t entry_count_;
+    size_t slot_count_;
+};
+
+class ShaderArchiveWriter {
+public:
+    ShaderArchiveWriter() : entries_() {}
+
+    // Replaces any entry with the same key.
+    void add(const std::string& key, std::vector<uint32_t> spirv_code);
+
+    void save(const std::string& path) const;
+
+    size_t size() const noexcept { return entries_.size(); }
+
+private:
+    struct Entry {
+        std::string key;
+        std::vector<uint32_t> spirv_code;
+    };
+
+private:
+    std::vector<Entry> entries_;
+};
+}  // namespace maseya::vkbase
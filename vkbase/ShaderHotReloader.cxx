@@ -0,0 +1,152 @@
+#include "ShaderHotReloader.hxx"
+
+#include <utility>
+
+namespace maseya::vkbase {
+ShaderHotReloader::ShaderHotReloader(VkDevice device, const Compiler& compiler,
+                                     std::chrono::milliseconds poll_interval)
+        : device_(device),
+          compiler_(compiler),
+          poll_interval_(poll_interval),
+          shaders_(),
+          on_error_(),
+          project_(compiler),
+          pending_mutex_(),
+          added_targets_(),
+          pending_results_(),
+          stop_mutex_(),
+          stop_condition_(),
+          stop_(false),
+          thread_(&ShaderHotReloader::run, this) {}
+
+ShaderHotReloader::~ShaderHotReloader() {
+    {
+        std::lock_guard lock(stop_mutex_);
+        stop_ = true;
+    }
+
+    stop_condition_.notify_all();
+    thread_.join();
+}
+
+size_t ShaderHotReloader::add_shader(ShaderTarget target, ReloadCallback on_reload) {
+    // Compiled here rather than by the project, so that neither this nor a build on
+    // the background thread waits for the other.
+    CompiledShaderTarget compiled_target = ShaderProject::compile(compiler_, target);
+
+    bool succeeded = compiled_target.result.succeeded();
+    std::string error_message = compiled_target.result.error_message;
+
+    // Created before the shader is registered, so that a failure leaves nothing behind.
+    ShaderModule shader_module(nullptr);
+    if (succeeded) {
+        shader_module = ShaderModule(device_, compiled_target.result.spirv_code);
+    }
+
+    size_t index = shaders_.size();
+    shaders_.push_back(
+            Shader{std::move(target), std::move(shader_module), std::move(on_reload)});
+    {
+        std::lock_guard lock(pending_mutex_);
+        added_targets_.push_back(std::move(compiled_target));
+    }
+
+    if (!succeeded && on_error_) {
+        on_error_(shaders_[index].target, error_message);
+    }
+
+    return index;
+}
+
+size_t ShaderHotReloader::apply(const std::vector<Frame>& frames) {
+    std::map<size_t, ShaderJobResult> results;
+    {
+        std::lock_guard lock(pending_mutex_);
+        if (pending_results_.empty()) {
+            return 0;
+        }
+
+        results.swap(pending_results_);
+    }
+
+    // Create every module before touching any shader so that a failure leaves all of
+    // them as they were, with their results queued again for the next call.
+    std::vector<std::pair<size_t, ShaderModule>> shader_modules;
+    try {
+        for (const auto& [index, result] : results) {
+            if (result.succeeded()) {
+                shader_modules.emplace_back(index,
+                                            ShaderModule(device_, result.spirv_code));
+            }
+        }
+    } catch (...) {
+        // Results queued meanwhile are newer, so they are kept over these.
+        std::lock_guard lock(pending_mutex_);
+        pending_results_.merge(results);
+        throw;
+    }
+
+    if (on_error_) {
+        for (const auto& [index, result] : results) {
+            if (!result.succeeded()) {
+                on_error_(shaders_[index].target, result.error_message);
+            }
+        }
+    }
+
+    if (shader_modules.empty()) {
+        return 0;
+    }
+
+    for (const auto& frame : frames) {
+        frame.wait_for_command();
+    }
+
+    for (auto& [index, shader_module] : shader_modules) {
+        Shader& shader = shaders_[index];
+        std::swap(shader.shader_module, shader_module);
+        if (shader.on_reload) {
+            shader.on_reload(*shader.shader_module);
+        }
+    }
+
+    return shader_modules.size();
+}
+
+void ShaderHotReloader::run() {
+    std::unique_lock stop_lock(stop_mutex_);
+    while (!stop_condition_.wait_for(stop_lock, poll_interval_,
+                                     [this]() { return stop_; })) {
+        stop_lock.unlock();
+        try {
+            build();
+        } catch (const std::exception&) {
+            // Editors often replace a file by deleting and renaming it, so a source
+            // may briefly be missing. Try again on the next poll.
+        }
+        stop_lock.lock();
+    }
+}
+
+void ShaderHotReloader::build() {
+    std::vector<CompiledShaderTarget> added_targets;
+    {
+        std::lock_guard lock(pending_mutex_);
+        added_targets.swap(added_targets_);
+    }
+
+    for (auto& compiled_target : added_targets) {
+        project_.add_target(std::move(compiled_target));
+    }
+
+    std::vector<size_t> indices = project_.build();
+    if (indices.empty()) {
+        return;
+    }
+
+    std::lock_guard lock(pending_mutex_);
+    for (size_t index : indices) {
+        pending_results_[index] = project_.result(index);
+    }
+}
+}  // namespace maseya::vkbase
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <vulkan/vulkan_core.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Compiler.hxx"
+#include "Frame.hxx"
+#include "ManagedSwapchain.hxx"
+#include "ShaderModule.hxx"
+#include "ShaderProject.hxx"
+
+namespace maseya::vkbase {
+// Watches shader sources and everything they include, recompiles changed shaders on
+// a background thread, and swaps in the new shader modules when apply() is called
+// between frames.
+//
+// add_shader(), shader_module() and apply() must all be called from the thread that
+// records frames. Apart from a shader's first compilation in add_shader(), compilation
+// runs on the background thread, and neither waits for the other.
+class ShaderHotReloader {
+public:
+    // Called from apply() with the new shader module once no frame is in flight, so
+    // pipelines built from the old module may be destroyed and rebuilt here. The old
+    // module is destroyed after the callback returns.
+    using ReloadCallback = std::function<void(VkShaderModule shader_module)>;
+
+    // Called from apply() when a changed shader fails to compile. The shader keeps
+    // its previous module. A broken shader is not compiled again, and so is reported
+    // once, until the contents of its source or of a file it includes change.
+    using ErrorCallback =
+            std::function<void(const ShaderTarget& target, const std::string& error)>;
+
+    ShaderHotReloader(VkDevice device, const Compiler& compiler,
+                      std::chrono::milliseconds poll_interval =
+                              std::chrono::milliseconds(250));
+
+    ShaderHotReloader(const ShaderHotReloader&) = delete;
+    ShaderHotReloader& operator=(const ShaderHotReloader&) = delete;
+
+    ~ShaderHotReloader();
+
+    // Compiles the shader and starts watching it. Throws if its source file does not
+    // exist. If it does not compile, the error is reported through the error callback
+    // and its shader module stays null until a change makes it compile, at which point
+    // the reload callback is called as usual.
+    size_t add_shader(ShaderTarget target, ReloadCallback on_reload = {});
+
+    void set_error_callback(ErrorCallback on_error) { on_error_ = std::move(on_error); }
+
+    VkShaderModule shader_module(size_t index) const {
+        return *shaders_[index].shader_module;
+    }
+
+    // Swaps in every shader recompiled since the last call, after waiting for the
+    // frames' command buffers to finish. Returns the number of shaders swapped.
+    size_t apply(const std::vector<Frame>& frames);
+    size_t apply(const ManagedSwapchain& swapchain) {
+        return apply(swapchain.frames());
+    }
+
+private:
+    struct Shader {
+        ShaderTarget target;
+        ShaderModule shader_module;
+        ReloadCallback on_reload;
+    };
+
+private:
+    void run();
+
+    // Adds the shaders compiled by add_shader() to the project, then rebuilds changed
+    // shaders and queues the results.
+    void build();
+
+private:
+    VkDevice device_;
+    const Compiler& compiler_;
+    std::chrono::milliseconds poll_interval_;
+
+    // Only used by the thread that records frames.
+    std::vector<Shader> shaders_;
+    ErrorCallback on_error_;
+
+    // Only used by the background thread.
+    ShaderProject project_;
+
+    // Shaders compiled by add_shader() that the background thread has yet to add to
+    // its project, in order, so that they get the same indices there.
+    std::mutex pending_mutex_;
+    std::vector<CompiledShaderTarget> added_targets_;
+
+    // Compilation results waiting for apply(), keyed by shader index. A shader that
+    // changes twice before apply() only keeps its latest result.
+    std::map<size_t, ShaderJobResult> pending_results_;
+
+    std::mutex stop_mutex_;
+    std::condition_variable stop_condition_;
+    bool stop_;
+
+    std::thread thread_;
+};
+}  // namespace maseya::vkbase
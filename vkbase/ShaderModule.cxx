@@ -0,0 +1,14 @@
+#include "ShaderModule.hxx"
+
+#include "vulkan_helper.hxx"
+
+namespace maseya::vkbase {
+ShaderModule::Destroyer::Destroyer(VkDevice device) noexcept : device(device) {}
+
+void ShaderModule::Destroyer::operator()(VkShaderModule shader_module) const noexcept {
+    vkDestroyShaderModule(device, shader_module, nullptr);
+}
+
+ShaderModule::ShaderModule(VkDevice device, const uint32_t* code, size_t size)
+        : shader_module_(create_shader_module(device, code, size), device) {}
+}  // namespace maseya::vkbase
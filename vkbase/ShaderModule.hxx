@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vulkan/vulkan_core.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "MappedFile.hxx"
+#include "UniqueObject.hxx"
+
+namespace maseya::vkbase {
+class ShaderModule {
+    struct Destroyer {
+        constexpr Destroyer() noexcept : device(nullptr) {}
+
+        Destroyer(VkDevice device) noexcept;
+
+        void operator()(VkShaderModule shader_module) const noexcept;
+
+        VkDevice device;
+    };
+
+public:
+    constexpr ShaderModule(std::nullptr_t) noexcept : shader_module_(nullptr) {}
+
+    ShaderModule(VkDevice device, const uint32_t* code, size_t size);
+    ShaderModule(VkDevice device, const std::vector<uint32_t>& code)
+            : ShaderModule(device, code.data(), code.size() * sizeof(uint32_t)) {}
+
+    // Reads precompiled SPIR-V straight from the mapping without copying it.
+    ShaderModule(VkDevice device, const MappedFile& file)
+            : ShaderModule(device, file.spirv_code().data(), file.size()) {}
+
+    VkShaderModule operator*() const noexcept { return *shader_module_; }
+
+    explicit operator bool() const noexcept {
+        return static_cast<bool>(shader_module_);
+    }
+
+private:
+    UniqueObject<VkShaderModule, Destroyer> shader_module_;
+};
+}  // namespace maseya::vkbase
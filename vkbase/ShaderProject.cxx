@@ -0,0 +1,128 @@
+#include "ShaderProject.hxx"
+
+#include <utility>
+
+#include "IncludeCache.hxx"
+#include "VulkanError.hxx"
+
+namespace maseya::vkbase {
+namespace {
+bool is_file_unchanged(IncludeCache& include_cache, const std::string& path,
+                       std::uint64_t content_hash, bool missing = false) {
+    IncludeFile include_file = include_cache.get(path);
+    if (!include_file.content) {
+        return missing;
+    }
+
+    return !missing && include_file.content_hash == content_hash;
+}
+}  // namespace
+
+ShaderProject::ShaderProject(const Compiler& compiler, AsyncFileLoader* file_loader)
+        : compiler_(compiler), file_loader_(file_loader), targets_() {}
+
+size_t ShaderProject::add_target(ShaderTarget target) {
+    targets_.push_back(TargetState{std::move(target), false, 0, 0, ShaderJobResult{}});
+    return targets_.size() - 1;
+}
+
+size_t ShaderProject::add_target(CompiledShaderTarget compiled_target) {
+    targets_.push_back(TargetState{std::move(compiled_target.target), true,
+                                   compiled_target.source_hash,
+                                   compiled_target.include_index_version,
+                                   std::move(compiled_target.result)});
+    return targets_.size() - 1;
+}
+
+CompiledShaderTarget ShaderProject::compile(const Compiler& compiler,
+                                            ShaderTarget target) {
+    IncludeFile source = compiler.include_cache()->get(target.input_filename);
+    if (!source.content) {
+        throw InvalidPathError("Could not find shader source file.",
+                               target.input_filename);
+    }
+
+    std::uint64_t include_index_version = compiler.include_index_version();
+    ShaderJob job{target.input_filename, target.shader_kind, *source.content,
+                  target.entrypoint_name, target.defines};
+    ShaderJobResult result = std::move(compiler.compile_batch(&job, 1, 1).front());
+    return CompiledShaderTarget{std::move(target), source.content_hash,
+                                include_index_version, std::move(result)};
+}
+
+std::vector<size_t> ShaderProject::build(unsigned thread_count) {
+    if (file_loader_) {
+        std::vector<std::string> paths;
+        for (const auto& state : targets_) {
+            paths.push_back(state.target.input_filename);
+            for (const auto& dependency : state.result.dependencies) {
+                paths.push_back(dependency.path);
+            }
+        }
+
+        compiler_.include_cache()->prefetch(paths, *file_loader_);
+    }
+
+    std::vector<size_t> indices;
+    std::vector<ShaderJob> jobs;
+    std::vector<std::uint64_t> source_hashes;
+    for (size_t i = 0; i < targets_.size(); i++) {
+        if (is_up_to_date(i)) {
+            continue;
+        }
+
+        // Compile the source exactly as it was hashed, so that a write racing the
+        // build is picked up by the next one.
+        const ShaderTarget& target = targets_[i].target;
+        IncludeFile source = compiler_.include_cache()->get(target.input_filename);
+        if (!source.content) {
+            throw InvalidPathError("Could not find shader source file.",
+                                   target.input_filename);
+        }
+
+        indices.push_back(i);
+        jobs.push_back(ShaderJob{target.input_filename, target.shader_kind,
+                                 *source.content, target.entrypoint_name,
+                                 target.defines});
+        source_hashes.push_back(source.content_hash);
+    }
+
+    // Taken before compiling, so that directories added meanwhile cause a retry.
+    std::uint64_t include_index_version = compiler_.include_index_version();
+
+    std::vector<ShaderJobResult> results = compiler_.compile_batch(jobs, thread_count);
+    for (size_t i = 0; i < indices.size(); i++) {
+        TargetState& state = targets_[indices[i]];
+        state.built = true;
+        state.source_hash = source_hashes[i];
+        state.include_index_version = include_index_version;
+        state.result = std::move(results[i]);
+    }
+
+    return indices;
+}
+
+bool ShaderProject::is_up_to_date(size_t index) const {
+    const TargetState& state = targets_[index];
+    IncludeCache& include_cache = *compiler_.include_cache();
+    if (!state.built || !is_file_unchanged(include_cache, state.target.input_filename,
+                                           state.source_hash)) {
+        return false;
+    }
+
+    // Changing the standard include directories may make an #include <...> that was
+    // not found resolve, or one that was found resolve to a file in another directory.
+    if (state.include_index_version != compiler_.include_index_version()) {
+        return false;
+    }
+
+    for (const auto& dependency : state.result.dependencies) {
+        if (!is_file_unchanged(include_cache, dependency.path, dependency.content_hash,
+                               dependency.missing)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+}  // namespace maseya::vkbase
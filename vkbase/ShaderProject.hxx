@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "AsyncFileLoader.hxx"
+#include "Compiler.hxx"
+
+namespace maseya::vkbase {
+struct ShaderTarget {
+    std::string input_filename;
+    ShaderKind shader_kind;
+    std::string entrypoint_name = "main";
+    std::vector<Define> defines;
+};
+
+// A target compiled on its own by ShaderProject::compile(), before it is added to a
+// project.
+struct CompiledShaderTarget {
+    ShaderTarget target;
+    std::uint64_t source_hash;
+    std::uint64_t include_index_version;
+    ShaderJobResult result;
+};
+
+// A set of shaders that are rebuilt incrementally. Each build recompiles only the
+// targets whose source file or any file it includes changed since they were last
+// compiled. Every target is also recompiled when the standard include directories
+// change, and a target that failed to compile when a file it could not find appears.
+class ShaderProject {
+public:
+    // With a file loader, each build first reads the sources of every target and the
+    // files they included last time all at once, instead of one after another as they
+    // are checked and compiled. The loader must outlive the project.
+    explicit ShaderProject(const Compiler& compiler,
+                           AsyncFileLoader* file_loader = nullptr);
+
+    ShaderProject(const ShaderProject&) = delete;
+    ShaderProject& operator=(const ShaderProject&) = delete;
+
+    // Returns the index of the target, which is compiled by the next build.
+    size_t add_target(ShaderTarget target);
+
+    // Returns the index of the target, which the next build only compiles again if it
+    // is out of date.
+    size_t add_target(CompiledShaderTarget compiled_target);
+
+    // Compiles a target without any project, e.g. on one thread while another builds
+    // the project it is meant for. Throws if the source file does not exist.
+    static CompiledShaderTarget compile(const Compiler& compiler, ShaderTarget target);
+
+    // Returns the indices of the targets that were compiled.
+    std::vector<size_t> build(unsigned thread_count = 0);
+
+    bool is_up_to_date(size_t index) const;
+
+    size_t size() const noexcept { return targets_.size(); }
+
+    const ShaderTarget& target(size_t index) const { return targets_[index].target; }
+
+    // The result of the target's most recent compilation.
+    const ShaderJobResult& result(size_t index) const {
+        return targets_[index].result;
+    }
+
+    const std::vector<uint32_t>& spirv_code(size_t index) const {
+        return targets_[index].result.spirv_code;
+    }
+
+private:
+    struct TargetState {
+        ShaderTarget target;
+        bool built;
+        std::uint64_t source_hash;
+        std::uint64_t include_index_version;
+        ShaderJobResult result;
+    };
+
+private:
+    const Compiler& compiler_;
+    AsyncFileLoader* file_loader_;
+    std::vector<TargetState> targets_;
+};
+}  // namespace maseya::vkbase
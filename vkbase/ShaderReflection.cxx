@@ -0,0 +1,689 @@
+#include "ShaderReflection.hxx"
+
+#include <algorithm>
+#include <optional>
+#include <sstream>
+#include <unordered_map>
+
+#include "VulkanError.hxx"
+#include "vulkan_helper.hxx"
+
+namespace maseya::vkbase {
+namespace {
+// The subset of the SPIR-V specification that reflection needs.
+constexpr uint32_t spirv_magic = 0x07230203;
+constexpr size_t spirv_header_size = 5;
+
+enum SpirvOp : uint32_t {
+    OpEntryPoint = 15,
+    OpTypeBool = 20,
+    OpTypeInt = 21,
+    OpTypeFloat = 22,
+    OpTypeVector = 23,
+    OpTypeMatrix = 24,
+    OpTypeImage = 25,
+    OpTypeSampler = 26,
+    OpTypeSampledImage = 27,
+    OpTypeArray = 28,
+    OpTypeRuntimeArray = 29,
+    OpTypeStruct = 30,
+    OpTypePointer = 32,
+    OpConstant = 43,
+    OpSpecConstant = 50,
+    OpVariable = 59,
+    OpDecorate = 71,
+    OpMemberDecorate = 72,
+};
+
+enum SpirvDecoration : uint32_t {
+    DecorationBlock = 2,
+    DecorationBufferBlock = 3,
+    DecorationArrayStride = 6,
+    DecorationMatrixStride = 7,
+    DecorationBuiltIn = 11,
+    DecorationLocation = 30,
+    DecorationBinding = 33,
+    DecorationDescriptorSet = 34,
+    DecorationOffset = 35,
+};
+
+enum SpirvStorageClass : uint32_t {
+    StorageClassUniformConstant = 0,
+    StorageClassInput = 1,
+    StorageClassUniform = 2,
+    StorageClassPushConstant = 9,
+    StorageClassStorageBuffer = 12,
+};
+
+enum SpirvDim : uint32_t {
+    DimBuffer = 5,
+    DimSubpassData = 6,
+};
+
+struct Decorations {
+    bool block = false;
+    bool buffer_block = false;
+    bool built_in = false;
+    std::optional<uint32_t> array_stride;
+    std::optional<uint32_t> matrix_stride;
+    std::optional<uint32_t> location;
+    std::optional<uint32_t> binding;
+    std::optional<uint32_t> descriptor_set;
+    std::optional<uint32_t> offset;
+};
+
+// A type declaration's opcode and the operands following its result id.
+struct SpirvType {
+    uint32_t opcode;
+    std::vector<uint32_t> operands;
+};
+
+struct SpirvVariable {
+    uint32_t id;
+    uint32_t pointer_type_id;
+    uint32_t storage_class;
+};
+
+class SpirvModule {
+public:
+    SpirvModule(const uint32_t* code, size_t word_count);
+
+    uint32_t execution_model() const noexcept { return execution_model_; }
+
+    const std::vector<SpirvVariable>& variables() const noexcept { return variables_; }
+
+    const SpirvType& get_type(uint32_t id) const;
+
+    const Decorations& get_decorations(uint32_t id) const;
+
+    const Decorations& get_member_decorations(uint32_t struct_id,
+                                              uint32_t member) const;
+
+    // Zero for runtime arrays.
+    uint32_t get_array_length(const SpirvType& array_type) const;
+
+    // The size of the type when laid out with its explicit offsets and strides.
+    uint32_t get_size(uint32_t type_id,
+                      std::optional<uint32_t> matrix_stride = std::nullopt) const;
+
+private:
+    void decorate(uint32_t id, uint32_t decoration, const uint32_t* literals,
+                  size_t literal_count);
+
+private:
+    uint32_t execution_model_;
+    std::unordered_map<uint32_t, SpirvType> types_;
+    std::unordered_map<uint32_t, uint32_t> constants_;
+    std::unordered_map<uint32_t, Decorations> decorations_;
+    std::unordered_map<uint32_t, std::vector<Decorations>> member_decorations_;
+    std::vector<SpirvVariable> variables_;
+};
+
+[[noreturn]] void throw_invalid_spirv() {
+    throw VkBaseError("Invalid or unsupported SPIR-V module.");
+}
+
+SpirvModule::SpirvModule(const uint32_t* code, size_t word_count)
+        : execution_model_(0),
+          types_(),
+          constants_(),
+          decorations_(),
+          member_decorations_(),
+          variables_() {
+    if (word_count < spirv_header_size || code[0] != spirv_magic) {
+        throw_invalid_spirv();
+    }
+
+    bool has_entry_point = false;
+    for (size_t i = spirv_header_size; i < word_count;) {
+        uint32_t opcode = code[i] & 0xFFFF;
+        uint32_t instruction_size = code[i] >> 16;
+        if (instruction_size == 0 || i + instruction_size > word_count) {
+            throw_invalid_spirv();
+        }
+
+        const uint32_t* operands = code + i + 1;
+        size_t operand_count = instruction_size - 1;
+        i += instruction_size;
+
+        switch (opcode) {
+            case OpEntryPoint:
+                // Modules from shaderc have exactly one entry point.
+                if (!has_entry_point && operand_count >= 1) {
+                    execution_model_ = operands[0];
+                    has_entry_point = true;
+                }
+                break;
+
+            case OpTypeBool:
+            case OpTypeInt:
+            case OpTypeFloat:
+            case OpTypeVector:
+            case OpTypeMatrix:
+            case OpTypeImage:
+            case OpTypeSampler:
+            case OpTypeSampledImage:
+            case OpTypeArray:
+            case OpTypeRuntimeArray:
+            case OpTypeStruct:
+            case OpTypePointer:
+                if (operand_count < 1) {
+                    throw_invalid_spirv();
+                }
+
+                types_[operands[0]] = SpirvType{
+                        opcode,
+                        std::vector<uint32_t>(operands + 1, operands + operand_count)};
+                break;
+
+            case OpConstant:
+            case OpSpecConstant:
+                if (operand_count >= 3) {
+                    constants_[operands[1]] = operands[2];
+                }
+                break;
+
+            case OpVariable:
+                if (operand_count < 3) {
+                    throw_invalid_spirv();
+                }
+
+                variables_.push_back({operands[1], operands[0], operands[2]});
+                break;
+
+            case OpDecorate:
+                if (operand_count < 2) {
+                    throw_invalid_spirv();
+                }
+
+                decorate(operands[0], operands[1], operands + 2, operand_count - 2);
+                break;
+
+            case OpMemberDecorate: {
+                if (operand_count < 3) {
+                    throw_invalid_spirv();
+                }
+
+                std::vector<Decorations>& members = member_decorations_[operands[0]];
+                if (members.size() <= operands[1]) {
+                    members.resize(operands[1] + 1);
+                }
+
+                Decorations& decorations = members[operands[1]];
+                uint32_t decoration = operands[2];
+                if (decoration == DecorationBuiltIn) {
+                    decorations.built_in = true;
+                } else if (operand_count >= 4 && decoration == DecorationOffset) {
+                    decorations.offset = operands[3];
+                } else if (operand_count >= 4 && decoration == DecorationMatrixStride) {
+                    decorations.matrix_stride = operands[3];
+                }
+                break;
+            }
+        }
+    }
+
+    if (!has_entry_point) {
+        throw_invalid_spirv();
+    }
+}
+
+const SpirvType& SpirvModule::get_type(uint32_t id) const {
+    auto it = types_.find(id);
+    if (it == types_.end()) {
+        throw_invalid_spirv();
+    }
+
+    return it->second;
+}
+
+const Decorations& SpirvModule::get_decorations(uint32_t id) const {
+    static const Decorations empty_decorations;
+    auto it = decorations_.find(id);
+    return it != decorations_.end() ? it->second : empty_decorations;
+}
+
+const Decorations& SpirvModule::get_member_decorations(uint32_t struct_id,
+                                                       uint32_t member) const {
+    static const Decorations empty_decorations;
+    auto it = member_decorations_.find(struct_id);
+    return it != member_decorations_.end() && member < it->second.size()
+                   ? it->second[member]
+                   : empty_decorations;
+}
+
+uint32_t SpirvModule::get_array_length(const SpirvType& array_type) const {
+    if (array_type.opcode == OpTypeRuntimeArray) {
+        return 0;
+    }
+
+    auto it = constants_.find(array_type.operands.at(1));
+    if (it == constants_.end()) {
+        throw_invalid_spirv();
+    }
+
+    return it->second;
+}
+
+uint32_t SpirvModule::get_size(uint32_t type_id,
+                               std::optional<uint32_t> matrix_stride) const {
+    const SpirvType& type = get_type(type_id);
+    switch (type.opcode) {
+        case OpTypeBool:
+            return 4;
+
+        case OpTypeInt:
+        case OpTypeFloat:
+            return type.operands.at(0) / 8;
+
+        case OpTypeVector:
+            return type.operands.at(1) * get_size(type.operands.at(0));
+
+        case OpTypeMatrix:
+            return type.operands.at(1) *
+                   matrix_stride.value_or(get_size(type.operands.at(0)));
+
+        case OpTypeArray:
+        case OpTypeRuntimeArray:
+            return get_array_length(type) *
+                   get_decorations(type_id).array_stride.value_or(
+                           get_size(type.operands.at(0)));
+
+        case OpTypeStruct: {
+            uint32_t size = 0;
+            for (uint32_t i = 0; i < type.operands.size(); i++) {
+                const Decorations& member = get_member_decorations(type_id, i);
+                uint32_t end = member.offset.value_or(size) +
+                               get_size(type.operands[i], member.matrix_stride);
+                size = std::max(size, end);
+            }
+
+            return size;
+        }
+
+        default:
+            throw_invalid_spirv();
+    }
+}
+
+void SpirvModule::decorate(uint32_t id, uint32_t decoration, const uint32_t* literals,
+                           size_t literal_count) {
+    Decorations& decorations = decorations_[id];
+    switch (decoration) {
+        case DecorationBlock:
+            decorations.block = true;
+            break;
+        case DecorationBufferBlock:
+            decorations.buffer_block = true;
+            break;
+        case DecorationBuiltIn:
+            decorations.built_in = true;
+            break;
+        default:
+            if (literal_count < 1) {
+                break;
+            }
+
+            switch (decoration) {
+                case DecorationArrayStride:
+                    decorations.array_stride = literals[0];
+                    break;
+                case DecorationLocation:
+                    decorations.location = literals[0];
+                    break;
+                case DecorationBinding:
+                    decorations.binding = literals[0];
+                    break;
+                case DecorationDescriptorSet:
+                    decorations.descriptor_set = literals[0];
+                    break;
+            }
+            break;
+    }
+}
+
+VkShaderStageFlagBits get_shader_stage(uint32_t execution_model) {
+    switch (execution_model) {
+        case 0:
+            return VK_SHADER_STAGE_VERTEX_BIT;
+        case 1:
+            return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+        case 2:
+            return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+        case 3:
+            return VK_SHADER_STAGE_GEOMETRY_BIT;
+        case 4:
+            return VK_SHADER_STAGE_FRAGMENT_BIT;
+        case 5:
+            return VK_SHADER_STAGE_COMPUTE_BIT;
+        default:
+            throw_invalid_spirv();
+    }
+}
+
+VkDescriptorType get_descriptor_type(const SpirvModule& module, uint32_t type_id,
+                                     uint32_t storage_class) {
+    const SpirvType& type = module.get_type(type_id);
+    switch (storage_class) {
+        case StorageClassStorageBuffer:
+            return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+        case StorageClassUniform:
+            // Storage buffers from SPIR-V before 1.3 are uniform BufferBlocks.
+            return module.get_decorations(type_id).buffer_block
+                           ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+                           : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+
+        case StorageClassUniformConstant:
+            switch (type.opcode) {
+                case OpTypeSampler:
+                    return VK_DESCRIPTOR_TYPE_SAMPLER;
+
+                case OpTypeSampledImage:
+                    return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+
+                case OpTypeImage: {
+                    // The operands are the sampled type, dimensionality, depth,
+                    // arrayed, multisampled and sampled.
+                    uint32_t dim = type.operands.at(1);
+                    bool storage = type.operands.at(5) == 2;
+                    if (dim == DimBuffer) {
+                        return storage ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER
+                                       : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+                    }
+                    if (dim == DimSubpassData) {
+                        return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+                    }
+
+                    return storage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE
+                                   : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+                }
+            }
+            break;
+    }
+
+    throw_invalid_spirv();
+}
+
+VkFormat get_vertex_format(const SpirvType& component_type, uint32_t component_count) {
+    static constexpr VkFormat float16_formats[] = {
+            VK_FORMAT_R16_SFLOAT, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_R16G16B16_SFLOAT,
+            VK_FORMAT_R16G16B16A16_SFLOAT};
+    static constexpr VkFormat float32_formats[] = {
+            VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT,
+            VK_FORMAT_R32G32B32A32_SFLOAT};
+    static constexpr VkFormat float64_formats[] = {
+            VK_FORMAT_R64_SFLOAT, VK_FORMAT_R64G64_SFLOAT, VK_FORMAT_R64G64B64_SFLOAT,
+            VK_FORMAT_R64G64B64A64_SFLOAT};
+    static constexpr VkFormat int32_formats[] = {
+            VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT,
+            VK_FORMAT_R32G32B32A32_SINT};
+    static constexpr VkFormat uint32_formats[] = {
+            VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT,
+            VK_FORMAT_R32G32B32A32_UINT};
+
+    if (component_count < 1 || component_count > 4) {
+        throw_invalid_spirv();
+    }
+
+    uint32_t width = component_type.operands.at(0);
+    const VkFormat* formats = nullptr;
+    if (component_type.opcode == OpTypeFloat) {
+        formats = width == 16   ? float16_formats
+                  : width == 32 ? float32_formats
+                  : width == 64 ? float64_formats
+                                : nullptr;
+    } else if (component_type.opcode == OpTypeInt && width == 32) {
+        formats = component_type.operands.at(1) ? int32_formats : uint32_formats;
+    }
+
+    if (!formats) {
+        throw_invalid_spirv();
+    }
+
+    return formats[component_count - 1];
+}
+
+void add_descriptor_set_layout_binding(
+        std::vector<std::vector<VkDescriptorSetLayoutBinding>>& descriptor_sets,
+        uint32_t set, const VkDescriptorSetLayoutBinding& binding) {
+    if (descriptor_sets.size() <= set) {
+        descriptor_sets.resize(set + 1);
+    }
+
+    std::vector<VkDescriptorSetLayoutBinding>& bindings = descriptor_sets[set];
+    auto it = std::lower_bound(bindings.begin(), bindings.end(), binding,
+                               [](const VkDescriptorSetLayoutBinding& lhs,
+                                  const VkDescriptorSetLayoutBinding& rhs) {
+                                   return lhs.binding < rhs.binding;
+                               });
+    if (it == bindings.end() || it->binding != binding.binding) {
+        bindings.insert(it, binding);
+        return;
+    }
+
+    if (it->descriptorType != binding.descriptorType ||
+        it->descriptorCount != binding.descriptorCount) {
+        std::stringstream ss;
+        ss << "Stages disagree on the type of descriptor set " << set << ", binding "
+           << binding.binding << ".";
+        throw VkBaseError(ss.str());
+    }
+
+    it->stageFlags |= binding.stageFlags;
+}
+}  // namespace
+
+ShaderReflection::ShaderReflection() noexcept
+        : stage_flags_(0),
+          descriptor_sets_(),
+          push_constant_ranges_(),
+          vertex_attribute_descriptions_(),
+          vertex_stride_(0) {}
+
+ShaderReflection::ShaderReflection(const uint32_t* code, size_t word_count,
+                                   uint32_t runtime_array_descriptor_count)
+        : ShaderReflection() {
+    SpirvModule module(code, word_count);
+    VkShaderStageFlagBits stage = get_shader_stage(module.execution_model());
+    stage_flags_ = stage;
+
+    struct VertexInput {
+        uint32_t location;
+        VkFormat format;
+        uint32_t size;
+    };
+    std::vector<VertexInput> vertex_inputs;
+    for (const auto& variable : module.variables()) {
+        const SpirvType& pointer_type = module.get_type(variable.pointer_type_id);
+        if (pointer_type.opcode != OpTypePointer) {
+            throw_invalid_spirv();
+        }
+
+        uint32_t type_id = pointer_type.operands.at(1);
+        const Decorations& decorations = module.get_decorations(variable.id);
+        switch (variable.storage_class) {
+            case StorageClassUniformConstant:
+            case StorageClassUniform:
+            case StorageClassStorageBuffer: {
+                if (!decorations.binding) {
+                    break;
+                }
+
+                // Arrays of resources become the binding's descriptor count.
+                uint32_t descriptor_count = 1;
+                for (const SpirvType* type = &module.get_type(type_id);
+                     type->opcode == OpTypeArray || type->opcode == OpTypeRuntimeArray;
+                     type = &module.get_type(type_id)) {
+                    if (type->opcode == OpTypeArray) {
+                        descriptor_count *= module.get_array_length(*type);
+                    } else if (runtime_array_descriptor_count != 0) {
+                        descriptor_count *= runtime_array_descriptor_count;
+                    } else {
+                        throw VkBaseError(
+                                "The shader uses a runtime sized descriptor array, "
+                                "which needs a runtime array descriptor count.");
+                    }
+
+                    type_id = type->operands.at(0);
+                }
+
+                VkDescriptorSetLayoutBinding binding{};
+                binding.binding = *decorations.binding;
+                binding.descriptorType =
+                        get_descriptor_type(module, type_id, variable.storage_class);
+                binding.descriptorCount = descriptor_count;
+                binding.stageFlags = stage;
+                add_descriptor_set_layout_binding(
+                        descriptor_sets_, decorations.descriptor_set.value_or(0),
+                        binding);
+                break;
+            }
+
+            case StorageClassPushConstant: {
+                const SpirvType& type = module.get_type(type_id);
+                if (type.opcode != OpTypeStruct || type.operands.empty()) {
+                    break;
+                }
+
+                uint32_t offset = UINT32_MAX;
+                for (uint32_t i = 0; i < type.operands.size(); i++) {
+                    const Decorations& member_decorations =
+                            module.get_member_decorations(type_id, i);
+                    offset = std::min(offset, member_decorations.offset.value_or(0));
+                }
+
+                VkPushConstantRange push_constant_range{};
+                push_constant_range.stageFlags = stage;
+                push_constant_range.offset = offset;
+                push_constant_range.size = module.get_size(type_id) - offset;
+                push_constant_ranges_.push_back(push_constant_range);
+                break;
+            }
+
+            case StorageClassInput: {
+                if (stage != VK_SHADER_STAGE_VERTEX_BIT || decorations.built_in ||
+                    !decorations.location) {
+                    break;
+                }
+
+                // Matrices and arrays take one location per column or element.
+                uint32_t location_count = 1;
+                const SpirvType* type = &module.get_type(type_id);
+                if (type->opcode == OpTypeArray) {
+                    location_count = module.get_array_length(*type);
+                    type = &module.get_type(type->operands.at(0));
+                }
+                if (type->opcode == OpTypeMatrix) {
+                    location_count *= type->operands.at(1);
+                    type = &module.get_type(type->operands.at(0));
+                }
+
+                uint32_t component_count = 1;
+                if (type->opcode == OpTypeVector) {
+                    component_count = type->operands.at(1);
+                    type = &module.get_type(type->operands.at(0));
+                }
+
+                VkFormat format = get_vertex_format(*type, component_count);
+                uint32_t size = component_count * type->operands.at(0) / 8;
+                for (uint32_t i = 0; i < location_count; i++) {
+                    vertex_inputs.push_back({*decorations.location + i, format, size});
+                }
+                break;
+            }
+        }
+    }
+
+    std::sort(vertex_inputs.begin(), vertex_inputs.end(),
+              [](const VertexInput& lhs, const VertexInput& rhs) {
+                  return lhs.location < rhs.location;
+              });
+    for (const auto& vertex_input : vertex_inputs) {
+        VkVertexInputAttributeDescription attribute_description{};
+        attribute_description.location = vertex_input.location;
+        attribute_description.binding = 0;
+        attribute_description.format = vertex_input.format;
+        attribute_description.offset = vertex_stride_;
+        vertex_attribute_descriptions_.push_back(attribute_description);
+
+        vertex_stride_ += vertex_input.size;
+    }
+}
+
+ShaderReflection& ShaderReflection::merge(const ShaderReflection& rhs) {
+    stage_flags_ |= rhs.stage_flags_;
+
+    for (uint32_t set = 0; set < rhs.descriptor_sets_.size(); set++) {
+        for (const auto& binding : rhs.descriptor_sets_[set]) {
+            add_descriptor_set_layout_binding(descriptor_sets_, set, binding);
+        }
+    }
+
+    // A single range visible to every stage that uses push constants is always
+    // valid, and keeps the pipeline layout key independent of the stage order.
+    for (const auto& range : rhs.push_constant_ranges_) {
+        if (push_constant_ranges_.empty()) {
+            push_constant_ranges_.push_back(range);
+            continue;
+        }
+
+        VkPushConstantRange& merged = push_constant_ranges_.front();
+        uint32_t end = std::max(merged.offset + merged.size, range.offset + range.size);
+        merged.offset = std::min(merged.offset, range.offset);
+        merged.size = end - merged.offset;
+        merged.stageFlags |= range.stageFlags;
+    }
+
+    if (vertex_attribute_descriptions_.empty()) {
+        vertex_attribute_descriptions_ = rhs.vertex_attribute_descriptions_;
+        vertex_stride_ = rhs.vertex_stride_;
+    }
+
+    return *this;
+}
+
+ShaderReflection ShaderReflection::merge(
+        const std::vector<ShaderReflection>& reflections) {
+    ShaderReflection result;
+    for (const auto& reflection : reflections) {
+        result.merge(reflection);
+    }
+
+    return result;
+}
+
+VkVertexInputBindingDescription ShaderReflection::get_vertex_binding_description(
+        VkVertexInputRate input_rate) const noexcept {
+    VkVertexInputBindingDescription binding_description{};
+    binding_description.binding = 0;
+    binding_description.stride = vertex_stride_;
+    binding_description.inputRate = input_rate;
+    return binding_description;
+}
+
+std::vector<VkDescriptorSetLayout> ShaderReflection::get_descriptor_set_layouts(
+        DescriptorSetLayoutManager& descriptor_set_layout_manager) const {
+    std::vector<VkDescriptorSetLayout> result;
+    for (const auto& bindings : descriptor_sets_) {
+        result.push_back(
+                *descriptor_set_layout_manager.get_descriptor_set_layout(bindings));
+    }
+
+    return result;
+}
+
+const PipelineLayout& ShaderReflection::get_pipeline_layout(
+        DescriptorSetLayoutManager& descriptor_set_layout_manager,
+        PipelineLayoutManager& pipeline_layout_manager) const {
+    std::vector<VkDescriptorSetLayout> descriptor_set_layouts =
+            get_descriptor_set_layouts(descriptor_set_layout_manager);
+
+    VkPipelineLayoutCreateInfo create_info =
+            get_pipeline_layout_create_info(descriptor_set_layouts);
+    create_info.pushConstantRangeCount =
+            static_cast<uint32_t>(push_constant_ranges_.size());
+    create_info.pPushConstantRanges = push_constant_ranges_.data();
+    return pipeline_layout_manager.get_pipeline_layout(create_info);
+}
+}  // namespace maseya::vkbase
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vulkan/vulkan_core.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "DescriptorSetLayoutManager.hxx"
+#include "PipelineLayoutManager.hxx"
+
+namespace maseya::vkbase {
+// Describes the resources a compiled SPIR-V module uses, so that descriptor set and
+// pipeline layouts can be derived from the shader instead of written by hand.
+// Reflections of the stages of one pipeline can be merged into a single one.
+//
+// SPIR-V does not distinguish dynamic buffers from regular ones, so uniform and
+// storage buffers are always reported with their non-dynamic descriptor types.
+// Runtime sized descriptor arrays have no descriptor count in the shader, so the
+// caller must supply one.
+class ShaderReflection {
+public:
+    ShaderReflection() noexcept;
+
+    // Runtime sized descriptor arrays get runtime_array_descriptor_count descriptors,
+    // e.g. the size of a bindless texture table. If it is zero, a shader that uses
+    // one is rejected.
+    ShaderReflection(const uint32_t* code, size_t word_count,
+                     uint32_t runtime_array_descriptor_count = 0);
+    explicit ShaderReflection(const std::vector<uint32_t>& code,
+                              uint32_t runtime_array_descriptor_count = 0)
+            : ShaderReflection(code.data(), code.size(),
+                               runtime_array_descriptor_count) {}
+
+    // Combines the stages of both reflections. Bindings used by both must agree on
+    // their type and count, and push constant ranges are joined into one range.
+    ShaderReflection& merge(const ShaderReflection& rhs);
+
+    static ShaderReflection merge(const std::vector<ShaderReflection>& reflections);
+
+    VkShaderStageFlags stage_flags() const noexcept { return stage_flags_; }
+
+    // Indexed by set number and sorted by binding. Sets below the highest one used
+    // that the shader does not use are empty.
+    const std::vector<std::vector<VkDescriptorSetLayoutBinding>>& descriptor_sets()
+            const noexcept {
+        return descriptor_sets_;
+    }
+
+    const std::vector<VkPushConstantRange>& push_constant_ranges() const noexcept {
+        return push_constant_ranges_;
+    }
+
+    // Vertex inputs sorted by location, as attributes of binding 0 with every input
+    // tightly packed in location order.
+    const std::vector<VkVertexInputAttributeDescription>&
+    vertex_attribute_descriptions() const noexcept {
+        return vertex_attribute_descriptions_;
+    }
+
+    VkVertexInputBindingDescription get_vertex_binding_description(
+            VkVertexInputRate input_rate = VK_VERTEX_INPUT_RATE_VERTEX) const noexcept;
+
+    // Returns one layout per set, in set order.
+    std::vector<VkDescriptorSetLayout> get_descriptor_set_layouts(
+            DescriptorSetLayoutManager& descriptor_set_layout_manager) const;
+
+    const PipelineLayout& get_pipeline_layout(
+            DescriptorSetLayoutManager& descriptor_set_layout_manager,
+            PipelineLayoutManager& pipeline_layout_manager) const;
+
+private:
+    VkShaderStageFlags stage_flags_;
+    std::vector<std::vector<VkDescriptorSetLayoutBinding>> descriptor_sets_;
+    std::vector<VkPushConstantRange> push_constant_ranges_;
+    std::vector<VkVertexInputAttributeDescription> vertex_attribute_descriptions_;
+    uint32_t vertex_stride_;
+};
+}  // namespace maseya::vkbase
@@ -0,0 +1,70 @@
+#include "SpecializationInfo.hxx"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <utility>
+
+#include "VulkanError.hxx"
+
+namespace maseya::vkbase {
+SpecializationInfo::SpecializationInfo(const SpecializationInfo& rhs)
+        : map_entries_(rhs.map_entries_), data_(rhs.data_), specialization_info_{} {
+    update_specialization_info();
+}
+
+SpecializationInfo::SpecializationInfo(SpecializationInfo&& rhs) noexcept
+        : map_entries_(std::move(rhs.map_entries_)),
+          data_(std::move(rhs.data_)),
+          specialization_info_{} {
+    update_specialization_info();
+    rhs.update_specialization_info();
+}
+
+SpecializationInfo& SpecializationInfo::operator=(const SpecializationInfo& rhs) {
+    map_entries_ = rhs.map_entries_;
+    data_ = rhs.data_;
+    update_specialization_info();
+    return *this;
+}
+
+SpecializationInfo& SpecializationInfo::operator=(SpecializationInfo&& rhs) noexcept {
+    std::swap(map_entries_, rhs.map_entries_);
+    std::swap(data_, rhs.data_);
+    update_specialization_info();
+    rhs.update_specialization_info();
+    return *this;
+}
+
+SpecializationInfo& SpecializationInfo::add_constant(uint32_t constant_id,
+                                                     const void* data, size_t size) {
+    auto it = std::find_if(map_entries_.begin(), map_entries_.end(),
+                           [constant_id](const VkSpecializationMapEntry& entry) {
+                               return entry.constantID == constant_id;
+                           });
+    if (it != map_entries_.end()) {
+        std::stringstream ss;
+        ss << "Specialization constant " << constant_id << " was already added.";
+        throw VkBaseError(ss.str());
+    }
+
+    VkSpecializationMapEntry entry{};
+    entry.constantID = constant_id;
+    entry.offset = static_cast<uint32_t>(data_.size());
+    entry.size = size;
+    map_entries_.push_back(entry);
+
+    data_.resize(data_.size() + size);
+    std::memcpy(data_.data() + entry.offset, data, size);
+
+    update_specialization_info();
+    return *this;
+}
+
+void SpecializationInfo::update_specialization_info() noexcept {
+    specialization_info_.mapEntryCount = static_cast<uint32_t>(map_entries_.size());
+    specialization_info_.pMapEntries = map_entries_.data();
+    specialization_info_.dataSize = data_.size();
+    specialization_info_.pData = data_.data();
+}
+}  // namespace maseya::vkbase
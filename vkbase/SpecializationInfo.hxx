@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vulkan/vulkan_core.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace maseya::vkbase {
+// Builds the data block and map entries for a VkSpecializationInfo. A single SPIR-V
+// module can then be specialized per pipeline instead of compiling one module per set
+// of preprocessor defines.
+class SpecializationInfo {
+public:
+    SpecializationInfo() noexcept : map_entries_(), data_(), specialization_info_{} {}
+
+    SpecializationInfo(const SpecializationInfo& rhs);
+    SpecializationInfo(SpecializationInfo&& rhs) noexcept;
+
+    SpecializationInfo& operator=(const SpecializationInfo& rhs);
+    SpecializationInfo& operator=(SpecializationInfo&& rhs) noexcept;
+
+    template <class T>
+    SpecializationInfo& add_constant(uint32_t constant_id, const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>,
+                      "Specialization constants must be trivially copyable.");
+
+        // SPIR-V booleans are 32 bits wide, so they must be passed as a VkBool32.
+        if constexpr (std::is_same_v<T, bool>) {
+            VkBool32 bool_value = value ? VK_TRUE : VK_FALSE;
+            return add_constant(constant_id, &bool_value, sizeof(bool_value));
+        } else {
+            return add_constant(constant_id, &value, sizeof(T));
+        }
+    }
+
+    SpecializationInfo& add_constant(uint32_t constant_id, const void* data,
+                                     size_t size);
+
+    bool empty() const noexcept { return map_entries_.empty(); }
+
+    const std::vector<VkSpecializationMapEntry>& map_entries() const noexcept {
+        return map_entries_;
+    }
+
+    const std::vector<std::byte>& data() const noexcept { return data_; }
+
+    // Returns null when no constants were added so the result can be passed straight
+    // to VkPipelineShaderStageCreateInfo::pSpecializationInfo.
+    const VkSpecializationInfo* get() const noexcept {
+        return empty() ? nullptr : &specialization_info_;
+    }
+
+private:
+    void update_specialization_info() noexcept;
+
+private:
+    std::vector<VkSpecializationMapEntry> map_entries_;
+    std::vector<std::byte> data_;
+    VkSpecializationInfo specialization_info_;
+};
+}  // namespace maseya::vkbase
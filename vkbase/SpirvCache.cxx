@@ -0,0 +1,231 @@
+#include "SpirvCache.hxx"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+#include "IncludeCache.hxx"
+
+namespace maseya::vkbase {
+namespace fs = std::filesystem;
+
+namespace {
+constexpr std::uint32_t entry_magic = 0x43535653;
+constexpr std::uint32_t entry_version = 1;
+constexpr const char* entry_extension = ".spvc";
+
+template <class T>
+void write_value(std::ostream& stream, const T& value) {
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <class T>
+bool read_value(std::istream& stream, T& value) {
+    return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+bool is_dependency_unchanged(IncludeCache& include_cache, const std::string& path,
+                             std::uint64_t content_hash) {
+    // The include cache hashes the file exactly as the include resolver reads it, and
+    // only rereads it when it was modified.
+    IncludeFile include_file = include_cache.get(path);
+    return include_file.content && include_file.content_hash == content_hash;
+}
+
+struct CacheEntry {
+    fs::path path;
+    std::uint64_t size;
+    fs::file_time_type last_write_time;
+};
+
+std::vector<CacheEntry> get_cache_entries(const std::string& directory) {
+    std::vector<CacheEntry> result;
+
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+        if (entry.path().extension() != entry_extension) {
+            continue;
+        }
+
+        std::error_code entry_ec;
+        CacheEntry cache_entry{entry.path(), entry.file_size(entry_ec),
+                               entry.last_write_time(entry_ec)};
+        if (!entry_ec) {
+            result.push_back(std::move(cache_entry));
+        }
+    }
+
+    return result;
+}
+}  // namespace
+
+SpirvCache::SpirvCache(const std::string& directory, std::uint64_t max_size)
+        : directory_(directory), max_size_(max_size), mutex_(), size_(0) {
+    fs::create_directories(directory_);
+
+    for (const auto& entry : get_cache_entries(directory_)) {
+        size_ += entry.size;
+    }
+
+    std::lock_guard lock(mutex_);
+    if (size_ > max_size_) {
+        evict();
+    }
+}
+
+std::optional<std::vector<uint32_t>> SpirvCache::find(
+        std::uint64_t key, IncludeCache& include_cache,
+        std::vector<ShaderDependency>* dependencies) const {
+    std::string path = get_entry_path(key);
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return std::nullopt;
+    }
+
+    std::uint32_t magic, version, dependency_count;
+    if (!read_value(file, magic) || magic != entry_magic ||
+        !read_value(file, version) || version != entry_version ||
+        !read_value(file, dependency_count)) {
+        return std::nullopt;
+    }
+
+    std::vector<ShaderDependency> entry_dependencies;
+    for (std::uint32_t i = 0; i < dependency_count; i++) {
+        std::uint32_t path_length;
+        if (!read_value(file, path_length)) {
+            return std::nullopt;
+        }
+
+        std::string dependency_path(path_length, '\0');
+        std::uint64_t content_hash;
+        if (!file.read(dependency_path.data(), path_length) ||
+            !read_value(file, content_hash) ||
+            !is_dependency_unchanged(include_cache, dependency_path, content_hash)) {
+            return std::nullopt;
+        }
+
+        entry_dependencies.push_back({std::move(dependency_path), content_hash});
+    }
+
+    std::uint32_t word_count;
+    if (!read_value(file, word_count)) {
+        return std::nullopt;
+    }
+
+    std::vector<uint32_t> result(word_count);
+    if (!file.read(reinterpret_cast<char*>(result.data()),
+                   static_cast<std::streamsize>(word_count * sizeof(uint32_t)))) {
+        return std::nullopt;
+    }
+    file.close();
+
+    // Refresh the modification time so that eviction removes the least recently used
+    // entries rather than the oldest ones.
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+
+    if (dependencies) {
+        *dependencies = std::move(entry_dependencies);
+    }
+
+    return result;
+}
+
+void SpirvCache::store(std::uint64_t key,
+                       const std::vector<ShaderDependency>& dependencies,
+                       const std::vector<uint32_t>& spirv_code) {
+    // Failing to store an entry only costs a recompile later, so errors are ignored.
+    std::string path = get_entry_path(key);
+    std::string temp_path = path + ".tmp" + std::to_string(std::random_device()());
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return;
+        }
+
+        write_value(file, entry_magic);
+        write_value(file, entry_version);
+        write_value(file, static_cast<std::uint32_t>(dependencies.size()));
+        for (const auto& dependency : dependencies) {
+            write_value(file, static_cast<std::uint32_t>(dependency.path.size()));
+            file.write(dependency.path.data(),
+                       static_cast<std::streamsize>(dependency.path.size()));
+            write_value(file, dependency.content_hash);
+        }
+
+        write_value(file, static_cast<std::uint32_t>(spirv_code.size()));
+        file.write(reinterpret_cast<const char*>(spirv_code.data()),
+                   static_cast<std::streamsize>(spirv_code.size() * sizeof(uint32_t)));
+    }
+
+    std::error_code ec;
+    std::uint64_t size = fs::file_size(temp_path, ec);
+    if (ec) {
+        fs::remove(temp_path, ec);
+        return;
+    }
+
+    // The entry may replace one with the same key, e.g. after its includes changed.
+    // Renaming under the lock keeps two stores of one key from both counting the
+    // entry they replace as removed.
+    std::lock_guard lock(mutex_);
+    std::error_code replaced_ec;
+    std::uint64_t replaced_size = fs::file_size(path, replaced_ec);
+    fs::rename(temp_path, path, ec);
+    if (ec) {
+        fs::remove(temp_path, ec);
+        return;
+    }
+
+    size_ += size;
+    if (!replaced_ec) {
+        size_ -= std::min(size_, replaced_size);
+    }
+    if (size_ > max_size_) {
+        evict();
+    }
+}
+
+void SpirvCache::clear() {
+    std::lock_guard lock(mutex_);
+
+    std::error_code ec;
+    for (const auto& entry : get_cache_entries(directory_)) {
+        fs::remove(entry.path, ec);
+    }
+
+    size_ = 0;
+}
+
+std::string SpirvCache::get_entry_path(std::uint64_t key) const {
+    std::stringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << key << entry_extension;
+    return (fs::path(directory_) / ss.str()).string();
+}
+
+void SpirvCache::evict() {
+    std::vector<CacheEntry> entries = get_cache_entries(directory_);
+    std::sort(entries.begin(), entries.end(),
+              [](const CacheEntry& lhs, const CacheEntry& rhs) {
+                  return lhs.last_write_time < rhs.last_write_time;
+              });
+
+    size_ = 0;
+    for (const auto& entry : entries) {
+        size_ += entry.size;
+    }
+
+    // Evict down to three quarters of the limit so that a full cache does not have to
+    // scan the directory on every store.
+    std::uint64_t target_size = max_size_ / 4 * 3;
+    std::error_code ec;
+    for (auto it = entries.begin(); it != entries.end() && size_ > target_size; ++it) {
+        if (fs::remove(it->path, ec)) {
+            size_ -= it->size;
+        }
+    }
+}
+}  // namespace maseya::vkbase
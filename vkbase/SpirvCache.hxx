@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Compiler.hxx"
+
+namespace maseya::vkbase {
+// A persistent, content addressed store of compiled SPIR-V. Each entry records the
+// includes it was compiled with and is only returned while their contents are
+// unchanged. Once the cache grows past its size limit the least recently used
+// entries are removed.
+//
+// The cache is safe to use from multiple threads, and entries are written atomically
+// so several processes may share one directory.
+class SpirvCache {
+public:
+    static constexpr std::uint64_t default_max_size = 256ull << 20;
+
+    explicit SpirvCache(const std::string& directory,
+                        std::uint64_t max_size = default_max_size);
+
+    SpirvCache(const SpirvCache&) = delete;
+    SpirvCache& operator=(const SpirvCache&) = delete;
+
+    // Returns the entry's SPIR-V and, if requested, the includes it was compiled with.
+    // The includes are checked against the cache the compiler read them through.
+    std::optional<std::vector<uint32_t>> find(
+            std::uint64_t key, IncludeCache& include_cache,
+            std::vector<ShaderDependency>* dependencies = nullptr) const;
+
+    void store(std::uint64_t key, const std::vector<ShaderDependency>& dependencies,
+               const std::vector<uint32_t>& spirv_code);
+
+    void clear();
+
+    const std::string& directory() const noexcept { return directory_; }
+
+    std::uint64_t max_size() const noexcept { return max_size_; }
+
+private:
+    std::string get_entry_path(std::uint64_t key) const;
+
+    void evict();
+
+private:
+    std::string directory_;
+    std::uint64_t max_size_;
+
+    mutable std::mutex mutex_;
+    std::uint64_t size_;
+};
+}  // namespace maseya::vkbase
@@ -0,0 +1,280 @@
+#include "SpirvOptimizer.hxx"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <unordered_map>
+#include <utility>
+
+#include "UniqueObject.hxx"
+#include "VulkanError.hxx"
+
+namespace maseya::vkbase {
+namespace {
+constexpr size_t spirv_header_size = 5;
+
+constexpr uint32_t OpSpecConstantTrue = 48;
+constexpr uint32_t OpSpecConstantFalse = 49;
+constexpr uint32_t OpSpecConstant = 50;
+constexpr uint32_t OpDecorate = 71;
+constexpr uint32_t DecorationSpecId = 1;
+
+// Run ahead of every other pass, so that they all see the constants as regular ones.
+// Freezing turns the specialization constants into constants, the folding and
+// propagation passes fold the conditions they feed, and branch elimination then
+// removes the code behind the conditions that became constant.
+const char* const specialization_flags[] = {
+        "--freeze-spec-const",
+        "--fold-spec-const-op-composite",
+        "--ccp",
+        "--eliminate-dead-branches",
+        "--eliminate-dead-code-aggressive",
+};
+
+void register_pass(spv_optimizer_t* optimizer, const std::string& flag) {
+    if (flag == "-O") {
+        spvOptimizerRegisterPerformancePasses(optimizer);
+    } else if (flag == "-Os") {
+        spvOptimizerRegisterSizePasses(optimizer);
+    } else if (!spvOptimizerRegisterPassFromFlag(optimizer, flag.c_str())) {
+        throw VkBaseError("Unknown SPIR-V optimizer flag: " + flag);
+    }
+}
+
+struct OptimizerDestroyer {
+    void operator()(spv_optimizer_t* optimizer) const noexcept {
+        spvOptimizerDestroy(optimizer);
+    }
+};
+
+struct OptimizerOptionsDestroyer {
+    void operator()(spv_optimizer_options options) const noexcept {
+        spvOptimizerOptionsDestroy(options);
+    }
+};
+
+struct BinaryDestroyer {
+    void operator()(spv_binary binary) const noexcept { spvBinaryDestroy(binary); }
+};
+
+// The message consumer takes no user data, and the optimizer reports on the calling
+// thread, so messages are collected through a thread local.
+thread_local std::string* optimizer_messages = nullptr;
+
+void consume_message(spv_message_level_t level, const char*,
+                     const spv_position_t* position, const char* message) {
+    if (!optimizer_messages || level > SPV_MSG_WARNING) {
+        return;
+    }
+
+    std::stringstream ss;
+    ss << "SPIR-V word " << position->index << ": " << message << "\n";
+    *optimizer_messages += ss.str();
+}
+
+spv_target_env get_target_env(ShaderEnvVersion env_version) {
+    switch (env_version) {
+        case ShaderEnvVersion::Vulkan_1_1:
+            return SPV_ENV_VULKAN_1_1;
+        case ShaderEnvVersion::Vulkan_1_2:
+            return SPV_ENV_VULKAN_1_2;
+        case ShaderEnvVersion::Vulkan_1_3:
+            return SPV_ENV_VULKAN_1_3;
+        case ShaderEnvVersion::OpenGl_4_5:
+            return SPV_ENV_OPENGL_4_5;
+        default:
+            return SPV_ENV_VULKAN_1_0;
+    }
+}
+
+size_t count_instructions(const std::vector<uint32_t>& spirv_code) {
+    size_t result = 0;
+    for (size_t i = spirv_header_size; i < spirv_code.size(); result++) {
+        uint32_t instruction_size = spirv_code[i] >> 16;
+        if (instruction_size == 0) {
+            break;
+        }
+
+        i += instruction_size;
+    }
+
+    return result;
+}
+
+// Replaces the default values of the module's specialization constants with the
+// given ones, so that the optimizer can treat them as regular constants.
+void apply_specialization(std::vector<uint32_t>& spirv_code,
+                          const SpecializationInfo& specialization_info) {
+    std::unordered_map<uint32_t, uint32_t> spec_ids;
+    for (size_t i = spirv_header_size; i < spirv_code.size();) {
+        uint32_t opcode = spirv_code[i] & 0xFFFF;
+        uint32_t instruction_size = spirv_code[i] >> 16;
+        if (instruction_size == 0 || i + instruction_size > spirv_code.size()) {
+            throw VkBaseError("Invalid SPIR-V module.");
+        }
+
+        if (opcode == OpDecorate && instruction_size >= 4 &&
+            spirv_code[i + 2] == DecorationSpecId) {
+            spec_ids[spirv_code[i + 1]] = spirv_code[i + 3];
+        }
+
+        i += instruction_size;
+    }
+
+    const std::vector<std::byte>& data = specialization_info.data();
+    for (size_t i = spirv_header_size; i < spirv_code.size();) {
+        uint32_t opcode = spirv_code[i] & 0xFFFF;
+        uint32_t instruction_size = spirv_code[i] >> 16;
+        size_t next = i + instruction_size;
+        if (opcode != OpSpecConstant && opcode != OpSpecConstantTrue &&
+            opcode != OpSpecConstantFalse) {
+            i = next;
+            continue;
+        }
+
+        auto spec_id = spec_ids.find(spirv_code[i + 2]);
+        const VkSpecializationMapEntry* entry = nullptr;
+        if (spec_id != spec_ids.end()) {
+            for (const auto& map_entry : specialization_info.map_entries()) {
+                if (map_entry.constantID == spec_id->second) {
+                    entry = &map_entry;
+                }
+            }
+        }
+
+        if (entry && opcode == OpSpecConstant) {
+            size_t size =
+                    std::min(entry->size, (instruction_size - 3) * sizeof(uint32_t));
+            std::memcpy(&spirv_code[i + 3], data.data() + entry->offset, size);
+        } else if (entry) {
+            VkBool32 value;
+            std::memcpy(&value, data.data() + entry->offset, sizeof(value));
+            spirv_code[i] = (instruction_size << 16) |
+                            (value ? OpSpecConstantTrue : OpSpecConstantFalse);
+        }
+
+        i = next;
+    }
+}
+}  // namespace
+
+SpirvOptimizer::SpirvOptimizer(ShaderEnvVersion env_version)
+        : target_env_(get_target_env(env_version)),
+          flags_(),
+          specialization_info_(),
+          state_key_(),
+          report_mutex_(),
+          reports_() {
+    state_key_ += "env=";
+    state_key_ += std::to_string(static_cast<int>(target_env_));
+    state_key_ += ';';
+}
+
+SpirvOptimizer& SpirvOptimizer::add_recipe(SpirvOptimizationRecipe recipe) {
+    switch (recipe) {
+        case SpirvOptimizationRecipe::Performance:
+            return add_pass("-O");
+        case SpirvOptimizationRecipe::Size:
+            return add_pass("-Os");
+        case SpirvOptimizationRecipe::StripDebugInfo:
+            return add_pass("--strip-debug");
+    }
+
+    throw VkBaseError("Unknown SPIR-V optimization recipe.");
+}
+
+SpirvOptimizer& SpirvOptimizer::add_pass(const std::string& flag) {
+    flags_.push_back(flag);
+
+    state_key_ += "pass=";
+    state_key_ += flag;
+    state_key_ += ';';
+    return *this;
+}
+
+SpirvOptimizer& SpirvOptimizer::add_specialization(
+        const SpecializationInfo& specialization_info) {
+    const std::vector<std::byte>& data = specialization_info.data();
+    for (const auto& entry : specialization_info.map_entries()) {
+        specialization_info_.add_constant(entry.constantID, data.data() + entry.offset,
+                                          entry.size);
+
+        std::stringstream ss;
+        ss << "constant=" << entry.constantID << ':';
+        for (size_t i = 0; i < entry.size; i++) {
+            ss << std::to_integer<int>(data[entry.offset + i]) << ',';
+        }
+        ss << ';';
+        state_key_ += ss.str();
+    }
+
+    return *this;
+}
+
+std::vector<uint32_t> SpirvOptimizer::optimize(const std::vector<uint32_t>& spirv_code,
+                                               const std::string& name) const {
+    std::vector<uint32_t> input = spirv_code;
+    if (!specialization_info_.empty()) {
+        apply_specialization(input, specialization_info_);
+    }
+
+    // Passes keep state while they run, so each call gets its own optimizer.
+    UniqueObject<spv_optimizer_t*, OptimizerDestroyer> optimizer(
+            spvOptimizerCreate(target_env_));
+    spvOptimizerSetMessageConsumer(*optimizer, consume_message);
+    if (!specialization_info_.empty()) {
+        for (const char* flag : specialization_flags) {
+            register_pass(*optimizer, flag);
+        }
+    }
+    for (const auto& flag : flags_) {
+        register_pass(*optimizer, flag);
+    }
+
+    UniqueObject<spv_optimizer_options, OptimizerOptionsDestroyer> options(
+            spvOptimizerOptionsCreate());
+    spvOptimizerOptionsSetRunValidator(*options, false);
+
+    std::string messages;
+    std::string* previous_messages = std::exchange(optimizer_messages, &messages);
+    spv_binary binary = nullptr;
+    spv_result_t result = spvOptimizerRun(*optimizer, input.data(), input.size(),
+                                          &binary, *options);
+    optimizer_messages = previous_messages;
+
+    UniqueObject<spv_binary, BinaryDestroyer> optimized_binary(binary);
+    if (result != SPV_SUCCESS || !binary) {
+        std::stringstream ss;
+        ss << "Failed to optimize SPIR-V";
+        if (!name.empty()) {
+            ss << " for " << name;
+        }
+        ss << ".\n" << messages;
+        throw VkBaseError(ss.str());
+    }
+
+    std::vector<uint32_t> output(binary->code, binary->code + binary->wordCount);
+
+    SpirvOptimizationReport report{name,
+                                   count_instructions(spirv_code),
+                                   count_instructions(output),
+                                   spirv_code.size() * sizeof(uint32_t),
+                                   output.size() * sizeof(uint32_t)};
+    {
+        std::lock_guard lock(report_mutex_);
+        reports_.push_back(std::move(report));
+    }
+
+    return output;
+}
+
+std::vector<SpirvOptimizationReport> SpirvOptimizer::reports() const {
+    std::lock_guard lock(report_mutex_);
+    return reports_;
+}
+
+void SpirvOptimizer::clear_reports() {
+    std::lock_guard lock(report_mutex_);
+    reports_.clear();
+}
+}  // namespace maseya::vkbase
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <spirv-tools/libspirv.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Compiler.hxx"
+#include "SpecializationInfo.hxx"
+
+namespace maseya::vkbase {
+enum class SpirvOptimizationRecipe {
+    // spirv-opt's -O pass list.
+    Performance,
+    // spirv-opt's -Os pass list.
+    Size,
+    StripDebugInfo,
+};
+
+struct SpirvOptimizationReport {
+    std::string name;
+    size_t instruction_count_before;
+    size_t instruction_count_after;
+    size_t size_before;
+    size_t size_after;
+};
+
+// Runs compiled SPIR-V through the SPIRV-Tools optimizer. Passes run in the order
+// they were added. Every optimization is recorded in a report of instruction counts
+// and sizes before and after, so changes in shader complexity can be tracked.
+//
+// Passes must be added before the optimizer is used. After that, optimize() may be
+// called from several threads at once.
+class SpirvOptimizer {
+public:
+    explicit SpirvOptimizer(
+            ShaderEnvVersion env_version = ShaderEnvVersion::Vulkan_1_0);
+
+    SpirvOptimizer(const SpirvOptimizer&) = delete;
+    SpirvOptimizer& operator=(const SpirvOptimizer&) = delete;
+
+    SpirvOptimizer& add_recipe(SpirvOptimizationRecipe recipe);
+
+    // Adds a pass by its spirv-opt command line flag, e.g. "--eliminate-dead-inserts".
+    SpirvOptimizer& add_pass(const std::string& flag);
+
+    // Bakes the constants into the module as the values of their specialization
+    // constants. Passes that fold them and remove the branches they make dead run
+    // before every added pass, so that the added passes also see them as constants.
+    // The result only matches pipelines created with the same constants.
+    SpirvOptimizer& add_specialization(const SpecializationInfo& specialization_info);
+
+    std::vector<uint32_t> optimize(const std::vector<uint32_t>& spirv_code,
+                                   const std::string& name = std::string()) const;
+
+    std::vector<SpirvOptimizationReport> reports() const;
+
+    void clear_reports();
+
+    // Describes every pass added so far, for keying caches of optimized SPIR-V.
+    const std::string& state_key() const noexcept { return state_key_; }
+
+private:
+    spv_target_env target_env_;
+
+    // spirv-opt command line flags, with "-O" and "-Os" standing for the recipes.
+    std::vector<std::string> flags_;
+    SpecializationInfo specialization_info_;
+    std::string state_key_;
+
+    mutable std::mutex report_mutex_;
+    mutable std::vector<SpirvOptimizationReport> reports_;
+};
+}  // namespace maseya::vkbase
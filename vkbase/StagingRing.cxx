@@ -0,0 +1,86 @@
+#include "StagingRing.hxx"
+
+#include <cassert>
+
+#include "VulkanError.hxx"
+#include "math_helper.hxx"
+#include "vulkan_helper.hxx"
+
+namespace maseya::vkbase {
+StagingRing::StagingRing(VkDevice device, VmaAllocator allocator, VkDeviceSize size)
+        : device_(device),
+          allocator_(allocator),
+          capacity_(align_up(size, max_alignment)),
+          buffer_(allocator, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, capacity_),
+          head_(0),
+          tail_(0),
+          frames_() {}
+
+std::optional<StagingSpan> StagingRing::allocate(VkDeviceSize size,
+                                                 VkDeviceSize alignment) {
+    if (alignment == 0 || (alignment & (alignment - 1)) || alignment > max_alignment) {
+        throw VkBaseError("Staging alignment must be a power of two up to 256.");
+    }
+
+    if (size > capacity_) {
+        return std::nullopt;
+    }
+
+    // The capacity is a multiple of every supported alignment, so aligning a position
+    // aligns its offset in the buffer as well.
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    uint64_t begin;
+    uint64_t end;
+    do {
+        begin = align_up<uint64_t>(head, alignment);
+
+        // Spans never wrap around the end of the buffer. Skip to its start instead.
+        if (begin % capacity_ + size > capacity_) {
+            begin += capacity_ - begin % capacity_;
+        }
+
+        end = begin + size;
+        if (end - tail_.load(std::memory_order_acquire) > capacity_) {
+            return std::nullopt;
+        }
+    } while (!head_.compare_exchange_weak(head, end, std::memory_order_relaxed));
+
+    VkDeviceSize offset = begin % capacity_;
+    return StagingSpan{static_cast<std::byte*>(buffer_.data()) + offset, *buffer_,
+                       offset, size, end};
+}
+
+void StagingRing::flush(const StagingSpan& span) const {
+    assert_result(vmaFlushAllocation(allocator_, buffer_.allocation(), span.offset,
+                                     span.size));
+}
+
+void StagingRing::end_frame(VkFence fence, uint64_t end) {
+    assert(vkGetFenceStatus(device_, fence) == VK_NOT_READY);
+
+    if (end > head_.load(std::memory_order_relaxed)) {
+        throw VkBaseError("Staging ring position was never allocated.");
+    }
+
+    // Spans up to an earlier end are already tied to an earlier fence.
+    if (end <= (frames_.empty() ? tail_.load(std::memory_order_relaxed)
+                                : frames_.back().end)) {
+        return;
+    }
+
+    frames_.push_back({fence, end});
+}
+
+void StagingRing::reclaim() {
+    while (!frames_.empty() && is_fence_idle(device_, frames_.front().fence)) {
+        tail_.store(frames_.front().end, std::memory_order_release);
+        frames_.pop_front();
+    }
+}
+
+VkDeviceSize StagingRing::used_size() const noexcept {
+    // Load the tail first so that the head read after it is never behind it.
+    uint64_t tail = tail_.load(std::memory_order_acquire);
+    return head_.load(std::memory_order_acquire) - tail;
+}
+}  // namespace maseya::vkbase
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vma/vk_mem_alloc.h>
+#include <vulkan/vulkan_core.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+#include "PersistantlyMappedBuffer.hxx"
+
+namespace maseya::vkbase {
+struct StagingSpan {
+    std::byte* data;
+    VkBuffer buffer;
+    VkDeviceSize offset;
+    VkDeviceSize size;
+
+    // The ring position just past the span, to hand to StagingRing::end_frame().
+    uint64_t ring_end;
+};
+
+// A host visible buffer that hands out staging memory for uploads as a ring, so that
+// uploading is a copy into the span followed by a copy command from the span's buffer
+// and offset, without creating a buffer per upload.
+//
+// Any thread may allocate without taking a lock. Space is reclaimed a frame at a time:
+// end_frame() ties the spans a submission reads to its fence, and reclaim() frees them
+// once that fence signals. Both must be called from the thread that submits frames.
+class StagingRing {
+    struct Frame {
+        VkFence fence;
+        uint64_t end;
+    };
+
+public:
+    // Alignments up to this are supported, which covers
+    // optimalBufferCopyOffsetAlignment and nonCoherentAtomSize on every device.
+    static constexpr VkDeviceSize max_alignment = 256;
+
+    StagingRing(VkDevice device, VmaAllocator allocator, VkDeviceSize size);
+
+    StagingRing(const StagingRing&) = delete;
+    StagingRing& operator=(const StagingRing&) = delete;
+
+    // Returns nothing if the ring is full until a frame is reclaimed, or if the size
+    // is larger than the ring. The alignment must be a power of two.
+    std::optional<StagingSpan> allocate(VkDeviceSize size,
+                                        VkDeviceSize alignment = 16);
+
+    // Must be called after writing to a span and before submitting the copy, in case
+    // the memory is not host coherent. Does nothing if it is.
+    void flush(const StagingSpan& span) const;
+
+    // The end is the largest ring_end of the spans whose copies the submission
+    // records, and everything before it is freed with the fence. Spans are handed
+    // out in ring order, so every span allocated before that one must be submitted by
+    // now as well, so workers must hand their spans to the submitting thread in the
+    // order they allocated them.
+    //
+    // The fence must be unsignaled, i.e. reset since it last signaled, and be the one
+    // the submission will signal, so call this after resetting it and before
+    // submitting. A fence that is still signaled from an earlier frame would free the
+    // spans while the copies still read them. Debug builds assert this.
+    void end_frame(VkFence fence, uint64_t end);
+
+    // Never waits on the fences.
+    void reclaim();
+
+    VkBuffer buffer() const noexcept { return *buffer_; }
+    VkDeviceSize capacity() const noexcept { return capacity_; }
+
+    // Bytes allocated and not yet reclaimed, including padding.
+    VkDeviceSize used_size() const noexcept;
+
+private:
+    VkDevice device_;
+    VmaAllocator allocator_;
+    VkDeviceSize capacity_;
+    PersistantlyMappedBuffer buffer_;
+
+    // Positions only ever grow, and wrap around the buffer modulo its capacity, so
+    // a full ring can be told apart from an empty one.
+    std::atomic<uint64_t> head_;
+    std::atomic<uint64_t> tail_;
+
+    std::deque<Frame> frames_;
+};
+}  // namespace maseya::vkbase
@@ -1,5 +1,9 @@
 #include "StbImage.hxx"
 
+#include <cstring>
+#include <memory>
+#include <utility>
+
 #include "VulkanError.hxx"
 #include "stb_image.h"
 #include "stb_image_write.h"
@@ -21,6 +25,17 @@ StbImage::StbImage(const char* path) : StbImage() {
     size_ = static_cast<size_t>(width_) * height_ * 4;
 }
 
+StbImage::StbImage(const std::byte* data, size_t size) : StbImage() {
+    pixels_ = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(data),
+                                    static_cast<int>(size), &width_, &height_,
+                                    &channels_, STBI_rgb_alpha);
+    if (!pixels_) {
+        throw VkBaseError("failed to load texture image!");
+    }
+
+    size_ = static_cast<size_t>(width_) * height_ * 4;
+}
+
 StbImage::StbImage(StbImage&& rhs) noexcept
         : width_(rhs.width_),
           height_(rhs.height_),
@@ -38,4 +53,49 @@ StbImage& StbImage::operator=(StbImage&& rhs) noexcept {
     std::swap(size_, rhs.size_);
     return *this;
 }
+
+StbImageInfo get_stb_image_info(const std::byte* data, size_t size) {
+    StbImageInfo result;
+    if (!stbi_info_from_memory(reinterpret_cast<const stbi_uc*>(data),
+                               static_cast<int>(size), &result.width, &result.height,
+                               &result.channels)) {
+        throw VkBaseError("failed to read texture image header!");
+    }
+
+    return result;
+}
+
+StbImageInfo decode_stb_image(const std::byte* data, size_t size,
+                              std::byte* destination, size_t row_pitch,
+                              size_t destination_size) {
+    StbImageInfo result;
+    std::unique_ptr<stbi_uc, decltype(&stbi_image_free)> pixels(
+            stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(data),
+                                  static_cast<int>(size), &result.width,
+                                  &result.height, &result.channels, STBI_rgb_alpha),
+            &stbi_image_free);
+    if (!pixels) {
+        throw VkBaseError("failed to load texture image!");
+    }
+
+    size_t row_size = static_cast<size_t>(result.width) * 4;
+    if (row_pitch < row_size ||
+        destination_size < row_pitch * (result.height - 1) + row_size) {
+        throw VkBaseError("Destination is too small for the decoded image.");
+    }
+
+    // This is the one copy left. Decoding into the destination directly would have
+    // stb_image read back earlier rows, e.g. for PNG filters, which is slow from
+    // write-combined memory. Rows are written in order, which such memory prefers.
+    if (row_pitch == row_size) {
+        std::memcpy(destination, pixels.get(), row_size * result.height);
+    } else {
+        for (int y = 0; y < result.height; y++) {
+            std::memcpy(destination + row_pitch * y, pixels.get() + row_size * y,
+                        row_size);
+        }
+    }
+
+    return result;
+}
 }  // namespace maseya::vkbase
\ No newline at end of file
@@ -1,8 +1,17 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 namespace maseya::vkbase {
+struct StbImageInfo {
+    int width;
+    int height;
+
+    // Channels in the encoded image. Decoded pixels always have four.
+    int channels;
+};
+
 class StbImage {
 private:
     StbImage() = default;
@@ -11,6 +20,10 @@ public:
     StbImage(int width, int height, int channels, unsigned char* pixels);
     StbImage(const char* path);
 
+    // Decodes an encoded image already in memory, such as one read by
+    // AsyncFileLoader.
+    StbImage(const std::byte* data, size_t size);
+
     StbImage(const StbImage&) = delete;
     StbImage(StbImage&& rhs) noexcept;
 
@@ -31,4 +44,16 @@ private:
     unsigned char* pixels_;
     size_t size_;
 };
+
+// Reads the dimensions of an encoded image without decoding it, so that memory for the
+// pixels can be set aside first.
+StbImageInfo get_stb_image_info(const std::byte* data, size_t size);
+
+// Decodes an encoded image to RGBA8 into the destination, such as a mapped staging
+// span, with rows row_pitch bytes apart. stb_image has no way to decode into a
+// caller's buffer, so it decodes into its own, which is copied to the destination
+// once and freed. Unlike StbImage, nothing is kept afterwards.
+StbImageInfo decode_stb_image(const std::byte* data, size_t size,
+                              std::byte* destination, size_t row_pitch,
+                              size_t destination_size);
 }  // namespace maseya::vkbase
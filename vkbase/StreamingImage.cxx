@@ -0,0 +1,164 @@
+#include "StreamingImage.hxx"
+
+#include <cstring>
+
+#include "ImageDesc.hxx"
+#include "VulkanError.hxx"
+#include "math_helper.hxx"
+#include "vulkan_helper.hxx"
+
+namespace maseya::vkbase {
+namespace {
+// Satisfies optimalBufferCopyOffsetAlignment and nonCoherentAtomSize on every device,
+// so each slice can be copied from and flushed on its own.
+constexpr VkDeviceSize slice_alignment = 256;
+
+size_t get_row_pitch(VkFormat format, const VkExtent2D& extent) {
+    uint32_t texel_size = get_texel_size(format);
+    if (texel_size == 0) {
+        throw VkBaseError("Streaming images need an uncompressed color format.");
+    }
+
+    return static_cast<size_t>(texel_size) * extent.width;
+}
+
+uint32_t get_slice_count(uint32_t slice_count) {
+    if (slice_count == 0) {
+        throw VkBaseError("Streaming images need at least one staging slice.");
+    }
+
+    return slice_count;
+}
+
+ImageDesc get_streaming_image_desc(VkFormat format, const VkExtent2D& extent) {
+    ImageDesc result;
+    result.format = format;
+    result.extent = {extent.width, extent.height, 1};
+    return result;
+}
+}  // namespace
+
+StreamingImage::StreamingImage(VkDevice device, VmaAllocator allocator, VkFormat format,
+                               const VkExtent2D& extent, uint32_t slice_count,
+                               VkPipelineStageFlags shader_stages)
+        : allocator_(allocator),
+          shader_stages_(shader_stages),
+          row_pitch_(get_row_pitch(format, extent)),
+          slice_size_(align_up<VkDeviceSize>(row_pitch_ * extent.height,
+                                             slice_alignment)),
+          slice_count_(get_slice_count(slice_count)),
+          slice_index_(slice_count_ - 1),
+          written_(false),
+          image_(device, allocator, get_streaming_image_desc(format, extent)),
+          image_view_(device, *image_, format),
+          staging_buffer_(allocator, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                          slice_size_ * slice_count_),
+          dirty_rects_(),
+          regions_() {}
+
+std::byte* StreamingImage::begin_update() noexcept {
+    slice_index_ = (slice_index_ + 1) % slice_count_;
+    return slice_data();
+}
+
+void StreamingImage::end_update(VkCommandBuffer command_buffer) {
+    VkBufferImageCopy region{};
+    region.bufferOffset = slice_offset();
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageExtent = {extent().width, extent().height, 1};
+    regions_.assign(1, region);
+
+    // The whole image is rewritten, so its old contents can be discarded.
+    record_copy(command_buffer, VK_IMAGE_LAYOUT_UNDEFINED, slice_size_);
+}
+
+void StreamingImage::update(VkCommandBuffer command_buffer, const void* pixels,
+                            size_t source_row_pitch) {
+    begin_update();
+    write_pixels(pixels, source_row_pitch);
+    end_update(command_buffer);
+}
+
+void StreamingImage::update(VkCommandBuffer command_buffer, const void* pixels,
+                            size_t source_row_pitch,
+                            const std::vector<VkRect2D>& dirty_rects) {
+    if (!written_) {
+        update(command_buffer, pixels, source_row_pitch);
+        return;
+    }
+
+    dirty_rects_.assign(dirty_rects.begin(), dirty_rects.end());
+    merge_dirty_rects(dirty_rects_, extent());
+    if (dirty_rects_.empty()) {
+        return;
+    }
+
+    begin_update();
+    uint32_t texel_size = get_texel_size(format());
+    VkDeviceSize size =
+            pack_image_regions(dirty_rects_, texel_size, slice_offset(), regions_) -
+            slice_offset();
+
+    // Alignment between many small rectangles could make them outgrow the slice.
+    if (size > slice_size_) {
+        write_pixels(pixels, source_row_pitch);
+        end_update(command_buffer);
+        return;
+    }
+
+    auto staging = static_cast<std::byte*>(staging_buffer_.data());
+    auto source = static_cast<const std::byte*>(pixels);
+    for (const auto& region : regions_) {
+        size_t row_size = static_cast<size_t>(region.imageExtent.width) * texel_size;
+        std::byte* destination = staging + region.bufferOffset;
+        const std::byte* row = source + source_row_pitch * region.imageOffset.y +
+                               static_cast<size_t>(region.imageOffset.x) * texel_size;
+        for (uint32_t y = 0; y < region.imageExtent.height; y++) {
+            std::memcpy(destination, row, row_size);
+            destination += row_size;
+            row += source_row_pitch;
+        }
+    }
+
+    // The rest of the image is kept from earlier updates.
+    record_copy(command_buffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, size);
+}
+
+std::byte* StreamingImage::slice_data() noexcept {
+    return static_cast<std::byte*>(staging_buffer_.data()) + slice_offset();
+}
+
+void StreamingImage::write_pixels(const void* pixels,
+                                  size_t source_row_pitch) noexcept {
+    std::byte* destination = slice_data();
+    auto source = static_cast<const std::byte*>(pixels);
+    if (source_row_pitch == row_pitch_) {
+        std::memcpy(destination, source, row_pitch_ * extent().height);
+        return;
+    }
+
+    for (uint32_t y = 0; y < extent().height; y++) {
+        std::memcpy(destination + row_pitch_ * y, source + source_row_pitch * y,
+                    row_pitch_);
+    }
+}
+
+void StreamingImage::record_copy(VkCommandBuffer command_buffer,
+                                 VkImageLayout old_layout, VkDeviceSize size) {
+    vmaFlushAllocation(allocator_, staging_buffer_.allocation(), slice_offset(), size);
+
+    // Only the reads of earlier frames have to finish before the copy, which needs no
+    // access mask.
+    image_memory_barrier(command_buffer, *image_, old_layout,
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                         written_ ? shader_stages_ : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         0, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_ACCESS_TRANSFER_WRITE_BIT);
+    copy_buffer_to_image(command_buffer, *staging_buffer_, *image_, regions_);
+    image_memory_barrier(command_buffer, *image_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                         shader_stages_, VK_ACCESS_SHADER_READ_BIT);
+    written_ = true;
+}
+}  // namespace maseya::vkbase
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <vma/vk_mem_alloc.h>
+#include <vulkan/vulkan_core.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Image.hxx"
+#include "ImageView.hxx"
+#include "PersistantlyMappedBuffer.hxx"
+
+namespace maseya::vkbase {
+// A sampled image whose pixels are rewritten by the CPU every frame, such as an
+// emulator's framebuffer. It keeps one host visible staging slice per frame in
+// flight, so an update is a write into the next slice and a recorded copy, with no
+// allocation and no wait on the GPU.
+//
+// Use slice_count = ManagedSwapchain::max_frames_in_flight() and update at most once
+// per frame, after the frame's fence has been waited on. The slice written then was
+// last read by the frame that fence belongs to.
+class StreamingImage {
+public:
+    StreamingImage(std::nullptr_t) noexcept
+            : allocator_(nullptr),
+              shader_stages_(0),
+              row_pitch_(0),
+              slice_size_(0),
+              slice_count_(0),
+              slice_index_(0),
+              written_(false),
+              image_(nullptr),
+              image_view_(nullptr),
+              staging_buffer_(nullptr),
+              dirty_rects_(),
+              regions_() {}
+
+    // The shader stages are the ones that sample the image, and that updates wait on.
+    StreamingImage(VkDevice device, VmaAllocator allocator, VkFormat format,
+                   const VkExtent2D& extent, uint32_t slice_count,
+                   VkPipelineStageFlags shader_stages =
+                           VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+    StreamingImage(const StreamingImage&) = delete;
+    StreamingImage(StreamingImage&&) noexcept = default;
+
+    StreamingImage& operator=(const StreamingImage&) = delete;
+    StreamingImage& operator=(StreamingImage&&) noexcept = default;
+
+    VkImage operator*() const noexcept { return *image_; }
+    const Image& image() const noexcept { return image_; }
+    VkImageView image_view() const noexcept { return *image_view_; }
+
+    VkFormat format() const noexcept { return image_.format(); }
+    const VkExtent2D& extent() const noexcept { return image_.extent(); }
+
+    // Bytes between rows in a staging slice. Rows are tightly packed.
+    size_t row_pitch() const noexcept { return row_pitch_; }
+    uint32_t slice_count() const noexcept { return slice_count_; }
+
+    // Moves on to the next staging slice and returns it to write the new pixels to.
+    // Pixel conversions from pixel_convert.hxx can write to it directly.
+    std::byte* begin_update() noexcept;
+
+    // Records the copy of the slice into the image, leaving the image in
+    // VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL. The copy waits for the shader stages
+    // of earlier frames to stop reading the image, and the shader stages of later
+    // commands wait for the copy.
+    void end_update(VkCommandBuffer command_buffer);
+
+    // Copies the pixels, whose rows are source_row_pitch bytes apart, between
+    // begin_update() and end_update().
+    void update(VkCommandBuffer command_buffer, const void* pixels,
+                size_t source_row_pitch);
+
+    // Like update(), but only the dirty rectangles of the pixels are packed into the
+    // slice and copied, with a single copy command, so that the upload scales with
+    // the area that changed. The first update is always a full one.
+    void update(VkCommandBuffer command_buffer, const void* pixels,
+                size_t source_row_pitch, const std::vector<VkRect2D>& dirty_rects);
+
+private:
+    std::byte* slice_data() noexcept;
+    VkDeviceSize slice_offset() const noexcept { return slice_size_ * slice_index_; }
+
+    void write_pixels(const void* pixels, size_t source_row_pitch) noexcept;
+
+    // Flushes the first size bytes of the slice and records the copy of regions_,
+    // with barriers around it.
+    void record_copy(VkCommandBuffer command_buffer, VkImageLayout old_layout,
+                     VkDeviceSize size);
+
+private:
+    VmaAllocator allocator_;
+    VkPipelineStageFlags shader_stages_;
+    size_t row_pitch_;
+    VkDeviceSize slice_size_;
+    uint32_t slice_count_;
+    uint32_t slice_index_;
+
+    // Until the first update, the image has no contents for earlier frames to read.
+    bool written_;
+
+    Image image_;
+    ImageView image_view_;
+    PersistantlyMappedBuffer staging_buffer_;
+
+    // Kept between updates so that their capacity is reused.
+    std::vector<VkRect2D> dirty_rects_;
+    std::vector<VkBufferImageCopy> regions_;
+};
+}  // namespace maseya::vkbase
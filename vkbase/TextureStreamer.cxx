@@ -0,0 +1,268 @@
+#include "TextureStreamer.hxx"
+
+#include <utility>
+
+#include "StbImage.hxx"
+#include "VulkanError.hxx"
+#include "math_helper.hxx"
+#include "vulkan_helper.hxx"
+
+namespace maseya::vkbase {
+namespace {
+// Satisfies the buffer offset alignment of copies for every 8, 16 and 32 bit format.
+constexpr VkDeviceSize staging_alignment = 16;
+}  // namespace
+
+TextureStreamer::TextureStreamer(VkDevice device, VmaAllocator allocator,
+                                 VkQueue transfer_queue,
+                                 uint32_t transfer_queue_family_index,
+                                 uint32_t graphics_queue_family_index,
+                                 VkDeviceSize staging_size,
+                                 unsigned decode_thread_count, VkFormat format,
+                                 VkPipelineStageFlags shader_stages)
+        : device_(device),
+          allocator_(allocator),
+          transfer_queue_(transfer_queue),
+          transfer_queue_family_index_(transfer_queue_family_index),
+          graphics_queue_family_index_(graphics_queue_family_index),
+          format_(format),
+          shader_stages_(shader_stages),
+          command_pool_(device, transfer_queue_family_index),
+          staging_buffer_(allocator, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, staging_size),
+          staging_mutex_(),
+          staging_condition_(),
+          staging_allocations_(),
+          stopping_(false),
+          decoded_mutex_(),
+          decoded_textures_(),
+          pending_count_(0),
+          next_id_(0),
+          upload_batches_(),
+          loader_(decode_thread_count) {}
+
+TextureStreamer::~TextureStreamer() {
+    {
+        std::lock_guard lock(staging_mutex_);
+        stopping_ = true;
+    }
+
+    // Workers waiting for staging space give up, so this does not wait on poll().
+    staging_condition_.notify_all();
+    loader_.wait_idle();
+
+    for (const auto& batch : upload_batches_) {
+        wait_for_fence(device_, *batch.fence);
+    }
+}
+
+size_t TextureStreamer::request(std::string path) {
+    size_t id;
+    {
+        std::lock_guard lock(decoded_mutex_);
+        id = next_id_++;
+        pending_count_++;
+    }
+
+    loader_.load(std::move(path),
+                 [this, id](FileLoadResult file) { decode(std::move(file), id); });
+    return id;
+}
+
+std::vector<StreamedTexture> TextureStreamer::poll(
+        VkCommandBuffer graphics_command_buffer) {
+    std::vector<StreamedTexture> result;
+
+    // Batches finish in submission order, so stop at the first busy one.
+    while (!upload_batches_.empty() &&
+           is_fence_idle(device_, *upload_batches_.front().fence)) {
+        UploadBatch& batch = upload_batches_.front();
+        for (auto& decoded : batch.textures) {
+            free_staging(decoded.staging_offset);
+
+            if (has_ownership_transfer()) {
+                image_ownership_barrier(
+                        graphics_command_buffer, *decoded.texture.image,
+                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                        transfer_queue_family_index_, graphics_queue_family_index_,
+                        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, shader_stages_,
+                        VK_ACCESS_SHADER_READ_BIT);
+            }
+
+            result.push_back(std::move(decoded.texture));
+        }
+
+        upload_batches_.pop_front();
+    }
+
+    std::vector<DecodedTexture> decoded_textures;
+    {
+        std::lock_guard lock(decoded_mutex_);
+        decoded_textures.swap(decoded_textures_);
+    }
+
+    std::vector<DecodedTexture> uploads;
+    for (auto& decoded : decoded_textures) {
+        if (decoded.texture.error) {
+            result.push_back(std::move(decoded.texture));
+        } else {
+            uploads.push_back(std::move(decoded));
+        }
+    }
+
+    if (!uploads.empty()) {
+        submit(std::move(uploads));
+    }
+
+    std::lock_guard lock(decoded_mutex_);
+    pending_count_ -= result.size();
+    return result;
+}
+
+size_t TextureStreamer::pending_count() const {
+    std::lock_guard lock(decoded_mutex_);
+    return pending_count_;
+}
+
+void TextureStreamer::decode(FileLoadResult file, size_t id) noexcept {
+    DecodedTexture decoded{
+            StreamedTexture{id, std::move(file.path), Image(nullptr), file.error}, 0};
+    if (!decoded.texture.error) {
+        try {
+            StbImageInfo info = get_stb_image_info(file.data.data(), file.data.size());
+            ImageDesc desc;
+            desc.format = format_;
+            desc.extent = {static_cast<uint32_t>(info.width),
+                           static_cast<uint32_t>(info.height), 1};
+            decoded.texture.image = Image(device_, allocator_, desc);
+
+            // The pixels are decoded straight into the staging ring, so the
+            // allocation has to be given back if decoding fails.
+            VkDeviceSize size = VkDeviceSize(info.width) * info.height * 4;
+            decoded.staging_offset = allocate_staging(size);
+            try {
+                decode_stb_image(file.data.data(), file.data.size(),
+                                 static_cast<std::byte*>(staging_buffer_.data()) +
+                                         decoded.staging_offset,
+                                 static_cast<size_t>(info.width) * 4, size);
+            } catch (...) {
+                free_staging(decoded.staging_offset);
+                throw;
+            }
+
+            vmaFlushAllocation(allocator_, staging_buffer_.allocation(),
+                               decoded.staging_offset, size);
+        } catch (...) {
+            decoded.texture.image = Image(nullptr);
+            decoded.texture.error = std::current_exception();
+        }
+    }
+
+    std::lock_guard lock(decoded_mutex_);
+    decoded_textures_.push_back(std::move(decoded));
+}
+
+VkDeviceSize TextureStreamer::allocate_staging(VkDeviceSize size) {
+    VkDeviceSize capacity = staging_buffer_.size();
+    size = align_up(size, staging_alignment);
+    if (size > capacity) {
+        throw VkBaseError("Texture does not fit in the staging buffer.");
+    }
+
+    std::unique_lock lock(staging_mutex_);
+    while (true) {
+        if (stopping_) {
+            throw VkBaseError("Texture streamer was destroyed.");
+        }
+
+        if (staging_allocations_.empty()) {
+            staging_allocations_.push_back({0, size, false});
+            return 0;
+        }
+
+        VkDeviceSize begin = staging_allocations_.front().offset;
+        const StagingAllocation& back = staging_allocations_.back();
+        VkDeviceSize end = back.offset + back.size;
+
+        // When the ring has not wrapped, the free space is split between its end and
+        // its start.
+        if (back.offset >= begin) {
+            if (capacity - end >= size) {
+                staging_allocations_.push_back({end, size, false});
+                return end;
+            }
+
+            if (begin >= size) {
+                staging_allocations_.push_back({0, size, false});
+                return 0;
+            }
+        } else if (begin - end >= size) {
+            staging_allocations_.push_back({end, size, false});
+            return end;
+        }
+
+        staging_condition_.wait(lock);
+    }
+}
+
+void TextureStreamer::free_staging(VkDeviceSize offset) {
+    {
+        std::lock_guard lock(staging_mutex_);
+        for (auto& allocation : staging_allocations_) {
+            if (allocation.offset == offset && !allocation.freed) {
+                allocation.freed = true;
+                break;
+            }
+        }
+
+        while (!staging_allocations_.empty() && staging_allocations_.front().freed) {
+            staging_allocations_.pop_front();
+        }
+    }
+
+    staging_condition_.notify_all();
+}
+
+void TextureStreamer::submit(std::vector<DecodedTexture> textures) {
+    UploadBatch batch{CommandBuffer(device_, *command_pool_), Fence(device_),
+                      std::move(textures)};
+
+    VkCommandBuffer command_buffer = *batch.command_buffer;
+    batch.command_buffer.begin(true);
+    for (const auto& decoded : batch.textures) {
+        const Image& image = decoded.texture.image;
+        transition_layout(command_buffer, *image, VK_IMAGE_LAYOUT_UNDEFINED,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        copy_buffer_to_image(command_buffer, *staging_buffer_, *image,
+                             image.extent().width, image.extent().height,
+                             decoded.staging_offset);
+
+        // A transfer-only queue cannot wait on shader stages, so the visibility half
+        // of the barrier is left to the acquire in poll().
+        if (has_ownership_transfer()) {
+            image_ownership_barrier(
+                    command_buffer, *image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                    transfer_queue_family_index_, graphics_queue_family_index_,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                    VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0);
+        } else {
+            image_memory_barrier(command_buffer, *image,
+                                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 VK_ACCESS_TRANSFER_WRITE_BIT, shader_stages_,
+                                 VK_ACCESS_SHADER_READ_BIT);
+        }
+    }
+    batch.command_buffer.end();
+
+    VkSubmitInfo submit_info{};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &command_buffer;
+    assert_result(vkQueueSubmit(transfer_queue_, 1, &submit_info, *batch.fence));
+
+    upload_batches_.push_back(std::move(batch));
+}
+}  // namespace maseya::vkbase
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <vma/vk_mem_alloc.h>
+#include <vulkan/vulkan_core.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "AsyncFileLoader.hxx"
+#include "CommandBuffer.hxx"
+#include "CommandPool.hxx"
+#include "Fence.hxx"
+#include "Image.hxx"
+#include "PersistantlyMappedBuffer.hxx"
+
+namespace maseya::vkbase {
+struct StreamedTexture {
+    size_t id;
+    std::string path;
+
+    // Null if the texture failed to load.
+    Image image;
+    std::exception_ptr error;
+};
+
+// Loads textures without blocking the render thread. Files are read and decoded on
+// worker threads straight into a persistently mapped staging ring, and the copies
+// are recorded in batches and submitted to a transfer queue. Finished textures are
+// handed back by poll(), already in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+//
+// When the transfer queue belongs to a different family than the graphics queue, the
+// transfer queue releases each image and poll() records the matching acquire on the
+// graphics command buffer it is given.
+class TextureStreamer {
+public:
+    // The shader stages are the ones that sample the textures, which the uploads are
+    // made visible to.
+    TextureStreamer(VkDevice device, VmaAllocator allocator, VkQueue transfer_queue,
+                    uint32_t transfer_queue_family_index,
+                    uint32_t graphics_queue_family_index,
+                    VkDeviceSize staging_size = VkDeviceSize(64) << 20,
+                    unsigned decode_thread_count = 0,
+                    VkFormat format = VK_FORMAT_R8G8B8A8_UNORM,
+                    VkPipelineStageFlags shader_stages =
+                            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // Waits for uploads already submitted and discards the rest.
+    ~TextureStreamer();
+
+    // Returns an id that identifies the texture when poll() hands it back.
+    size_t request(std::string path);
+
+    // Submits every texture decoded since the last call, and returns every texture
+    // whose upload has finished. Never waits on the GPU. Must be called from one
+    // thread, which is also the only one allowed to use the transfer queue.
+    //
+    // Queue family acquires are recorded on the command buffer, so the returned
+    // textures may be sampled by any command recorded after this call.
+    std::vector<StreamedTexture> poll(VkCommandBuffer graphics_command_buffer);
+
+    // Number of requested textures not yet returned by poll().
+    size_t pending_count() const;
+
+private:
+    struct StagingAllocation {
+        VkDeviceSize offset;
+        VkDeviceSize size;
+        bool freed;
+    };
+
+    struct DecodedTexture {
+        StreamedTexture texture;
+        VkDeviceSize staging_offset;
+    };
+
+    struct UploadBatch {
+        CommandBuffer command_buffer;
+        Fence fence;
+        std::vector<DecodedTexture> textures;
+    };
+
+private:
+    // Runs on the decode workers.
+    void decode(FileLoadResult file, size_t id) noexcept;
+
+    // Blocks until the staging ring has room. Throws if the size can never fit.
+    VkDeviceSize allocate_staging(VkDeviceSize size);
+    void free_staging(VkDeviceSize offset);
+
+    void submit(std::vector<DecodedTexture> textures);
+
+    bool has_ownership_transfer() const noexcept {
+        return transfer_queue_family_index_ != graphics_queue_family_index_;
+    }
+
+private:
+    VkDevice device_;
+    VmaAllocator allocator_;
+    VkQueue transfer_queue_;
+    uint32_t transfer_queue_family_index_;
+    uint32_t graphics_queue_family_index_;
+    VkFormat format_;
+    VkPipelineStageFlags shader_stages_;
+
+    CommandPool command_pool_;
+    PersistantlyMappedBuffer staging_buffer_;
+
+    // Allocations are handed out in order from a ring, and the ring only advances
+    // past an allocation once every allocation before it is freed too.
+    std::mutex staging_mutex_;
+    std::condition_variable staging_condition_;
+    std::deque<StagingAllocation> staging_allocations_;
+    bool stopping_;
+
+    mutable std::mutex decoded_mutex_;
+    std::vector<DecodedTexture> decoded_textures_;
+    size_t pending_count_;
+    size_t next_id_;
+
+    std::deque<UploadBatch> upload_batches_;
+
+    // Declared last so that its workers stop before anything they use is destroyed.
+    AsyncFileLoader loader_;
+};
+}  // namespace maseya::vkbase
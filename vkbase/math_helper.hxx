@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <functional>
+#include <string>
 #include <type_traits>
 #include <unordered_set>
 #include <vector>
@@ -112,4 +113,32 @@ inline void hash_combine_invariant(std::size_t& seed,
                                    const std::unordered_set<T, Hasher, Equal>& items) {
     hash_combine_invariant(seed, items.begin(), items.end(), Hasher());
 }
+
+// 64-bit FNV-1a. Unlike std::hash, the result is stable across builds and platforms,
+// so it can be used for keys that are persisted to disk.
+constexpr std::uint64_t fnv1a_64_offset_basis = 0xcbf29ce484222325;
+
+inline std::uint64_t fnv1a_64(const void* data, std::size_t size,
+                              std::uint64_t hash = fnv1a_64_offset_basis) noexcept {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3;
+    }
+
+    return hash;
+}
+
+inline std::uint64_t fnv1a_64(const std::string& str,
+                              std::uint64_t hash = fnv1a_64_offset_basis) noexcept {
+    // Include the terminator so that consecutive strings cannot run together.
+    return fnv1a_64(str.c_str(), str.size() + 1, hash);
+}
+
+// Rounds up to a multiple of the alignment, which must be a power of two.
+template <class T>
+constexpr T align_up(T value, T alignment) noexcept {
+    static_assert(std::is_unsigned_v<T>);
+    return (value + alignment - 1) & ~(alignment - 1);
+}
 }  // namespace maseya
\ No newline at end of file
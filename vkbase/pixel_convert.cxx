@@ -0,0 +1,529 @@
+#include "pixel_convert.hxx"
+
+#include <array>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define MASEYA_VKBASE_PIXEL_CONVERT_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(__ARM_NEON)
+#define MASEYA_VKBASE_PIXEL_CONVERT_NEON
+#include <arm_neon.h>
+#endif
+
+// MSVC compiles intrinsics for any instruction set, but GCC and Clang only do so in
+// functions that are marked for it.
+#if defined(__GNUC__) || defined(__clang__)
+#define MASEYA_VKBASE_TARGET(isa) __attribute__((target(isa)))
+#else
+#define MASEYA_VKBASE_TARGET(isa)
+#endif
+
+namespace maseya::vkbase {
+namespace {
+using Kernel = void (*)(const uint8_t* source, uint8_t* destination, size_t count);
+using Kernel16 = void (*)(const uint16_t* source, uint8_t* destination, size_t count);
+
+struct PixelKernels {
+    const char* isa;
+    Kernel swizzle_rgba8_bgra8;
+    Kernel16 convert_bgr555_to_bgra8;
+    Kernel16 convert_rgb565_to_bgra8;
+    Kernel premultiply_alpha;
+};
+
+// Exactly round(x / 255) for any product of two bytes, without a division.
+constexpr uint8_t divide_by_255(unsigned x) noexcept {
+    x += 128;
+    return static_cast<uint8_t>((x + (x >> 8)) >> 8);
+}
+
+constexpr uint8_t expand_5(unsigned x) noexcept {
+    return static_cast<uint8_t>(x << 3 | x >> 2);
+}
+
+constexpr uint8_t expand_6(unsigned x) noexcept {
+    return static_cast<uint8_t>(x << 2 | x >> 4);
+}
+
+void swizzle_rgba8_bgra8_scalar(const uint8_t* source, uint8_t* destination,
+                                size_t count) {
+    for (size_t i = 0; i < count; i++, source += 4, destination += 4) {
+        uint8_t r = source[0];
+        uint8_t b = source[2];
+        destination[0] = b;
+        destination[1] = source[1];
+        destination[2] = r;
+        destination[3] = source[3];
+    }
+}
+
+void convert_bgr555_to_bgra8_scalar(const uint16_t* source, uint8_t* destination,
+                                    size_t count) {
+    for (size_t i = 0; i < count; i++, destination += 4) {
+        unsigned pixel = source[i];
+        destination[0] = expand_5(pixel >> 10 & 0x1F);
+        destination[1] = expand_5(pixel >> 5 & 0x1F);
+        destination[2] = expand_5(pixel & 0x1F);
+        destination[3] = 0xFF;
+    }
+}
+
+void convert_rgb565_to_bgra8_scalar(const uint16_t* source, uint8_t* destination,
+                                    size_t count) {
+    for (size_t i = 0; i < count; i++, destination += 4) {
+        unsigned pixel = source[i];
+        destination[0] = expand_5(pixel & 0x1F);
+        destination[1] = expand_6(pixel >> 5 & 0x3F);
+        destination[2] = expand_5(pixel >> 11);
+        destination[3] = 0xFF;
+    }
+}
+
+void premultiply_alpha_scalar(const uint8_t* source, uint8_t* destination,
+                              size_t count) {
+    for (size_t i = 0; i < count; i++, source += 4, destination += 4) {
+        unsigned alpha = source[3];
+        destination[0] = divide_by_255(source[0] * alpha);
+        destination[1] = divide_by_255(source[1] * alpha);
+        destination[2] = divide_by_255(source[2] * alpha);
+        destination[3] = static_cast<uint8_t>(alpha);
+    }
+}
+
+constexpr PixelKernels scalar_kernels{"scalar", swizzle_rgba8_bgra8_scalar,
+                                      convert_bgr555_to_bgra8_scalar,
+                                      convert_rgb565_to_bgra8_scalar,
+                                      premultiply_alpha_scalar};
+
+#if defined(MASEYA_VKBASE_PIXEL_CONVERT_X86)
+// SSE2 has no byte shuffle, so red and blue are swapped with 32 bit shifts.
+MASEYA_VKBASE_TARGET("sse2")
+void swizzle_rgba8_bgra8_sse2(const uint8_t* source, uint8_t* destination,
+                              size_t count) {
+    const __m128i red_blue_mask = _mm_set1_epi32(0x00FF00FF);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+        __m128i red_blue = _mm_and_si128(pixels, red_blue_mask);
+        __m128i green_alpha = _mm_andnot_si128(red_blue_mask, pixels);
+        red_blue = _mm_or_si128(_mm_slli_epi32(red_blue, 16),
+                                _mm_srli_epi32(red_blue, 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination),
+                         _mm_or_si128(red_blue, green_alpha));
+        source += 16;
+        destination += 16;
+    }
+
+    swizzle_rgba8_bgra8_scalar(source, destination, count - i);
+}
+
+// Takes each channel expanded to eight bits in the low byte of 16 bit lanes.
+MASEYA_VKBASE_TARGET("sse2")
+void store_bgra8_sse2(uint8_t* destination, __m128i blue, __m128i green, __m128i red) {
+    __m128i blue_green = _mm_or_si128(blue, _mm_slli_epi16(green, 8));
+    __m128i red_alpha = _mm_or_si128(red, _mm_set1_epi16(-256));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(destination),
+                     _mm_unpacklo_epi16(blue_green, red_alpha));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 16),
+                     _mm_unpackhi_epi16(blue_green, red_alpha));
+}
+
+MASEYA_VKBASE_TARGET("sse2")
+__m128i expand_5_sse2(__m128i x) {
+    return _mm_or_si128(_mm_slli_epi16(x, 3), _mm_srli_epi16(x, 2));
+}
+
+MASEYA_VKBASE_TARGET("sse2")
+void convert_bgr555_to_bgra8_sse2(const uint16_t* source, uint8_t* destination,
+                                  size_t count) {
+    const __m128i mask = _mm_set1_epi16(0x1F);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        __m128i red = expand_5_sse2(_mm_and_si128(pixels, mask));
+        __m128i green = expand_5_sse2(_mm_and_si128(_mm_srli_epi16(pixels, 5), mask));
+        __m128i blue = expand_5_sse2(_mm_and_si128(_mm_srli_epi16(pixels, 10), mask));
+        store_bgra8_sse2(destination, blue, green, red);
+        destination += 32;
+    }
+
+    convert_bgr555_to_bgra8_scalar(source + i, destination, count - i);
+}
+
+MASEYA_VKBASE_TARGET("sse2")
+void convert_rgb565_to_bgra8_sse2(const uint16_t* source, uint8_t* destination,
+                                  size_t count) {
+    const __m128i mask_5 = _mm_set1_epi16(0x1F);
+    const __m128i mask_6 = _mm_set1_epi16(0x3F);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        __m128i blue = expand_5_sse2(_mm_and_si128(pixels, mask_5));
+        __m128i green = _mm_and_si128(_mm_srli_epi16(pixels, 5), mask_6);
+        green = _mm_or_si128(_mm_slli_epi16(green, 2), _mm_srli_epi16(green, 4));
+        __m128i red = expand_5_sse2(_mm_srli_epi16(pixels, 11));
+        store_bgra8_sse2(destination, blue, green, red);
+        destination += 32;
+    }
+
+    convert_rgb565_to_bgra8_scalar(source + i, destination, count - i);
+}
+
+// Premultiplies two pixels held in 16 bit lanes.
+MASEYA_VKBASE_TARGET("sse2")
+__m128i premultiply_sse2(__m128i pixels) {
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, 0xFF), 0xFF);
+    __m128i product =
+            _mm_add_epi16(_mm_mullo_epi16(pixels, alpha), _mm_set1_epi16(128));
+    product = _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+
+    // Alpha itself is kept rather than scaled by itself.
+    const __m128i alpha_mask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    return _mm_or_si128(_mm_andnot_si128(alpha_mask, product),
+                        _mm_and_si128(alpha_mask, pixels));
+}
+
+MASEYA_VKBASE_TARGET("sse2")
+void premultiply_alpha_sse2(const uint8_t* source, uint8_t* destination,
+                            size_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+        __m128i low = premultiply_sse2(_mm_unpacklo_epi8(pixels, zero));
+        __m128i high = premultiply_sse2(_mm_unpackhi_epi8(pixels, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination),
+                         _mm_packus_epi16(low, high));
+        source += 16;
+        destination += 16;
+    }
+
+    premultiply_alpha_scalar(source, destination, count - i);
+}
+
+constexpr PixelKernels sse2_kernels{"sse2", swizzle_rgba8_bgra8_sse2,
+                                    convert_bgr555_to_bgra8_sse2,
+                                    convert_rgb565_to_bgra8_sse2,
+                                    premultiply_alpha_sse2};
+
+MASEYA_VKBASE_TARGET("avx2")
+void swizzle_rgba8_bgra8_avx2(const uint8_t* source, uint8_t* destination,
+                              size_t count) {
+    const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14,
+                                             13, 12, 15, 2, 1, 0, 3, 6, 5, 4, 7, 10, 9,
+                                             8, 11, 14, 13, 12, 15);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination),
+                            _mm256_shuffle_epi8(pixels, shuffle));
+        source += 32;
+        destination += 32;
+    }
+
+    swizzle_rgba8_bgra8_scalar(source, destination, count - i);
+}
+
+// Unpacking works within 128 bit halves, so the halves are put back in pixel order
+// before storing.
+MASEYA_VKBASE_TARGET("avx2")
+void store_bgra8_avx2(uint8_t* destination, __m256i blue, __m256i green, __m256i red) {
+    __m256i blue_green = _mm256_or_si256(blue, _mm256_slli_epi16(green, 8));
+    __m256i red_alpha = _mm256_or_si256(red, _mm256_set1_epi16(-256));
+    __m256i low = _mm256_unpacklo_epi16(blue_green, red_alpha);
+    __m256i high = _mm256_unpackhi_epi16(blue_green, red_alpha);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination),
+                        _mm256_permute2x128_si256(low, high, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + 32),
+                        _mm256_permute2x128_si256(low, high, 0x31));
+}
+
+MASEYA_VKBASE_TARGET("avx2")
+__m256i expand_5_avx2(__m256i x) {
+    return _mm256_or_si256(_mm256_slli_epi16(x, 3), _mm256_srli_epi16(x, 2));
+}
+
+MASEYA_VKBASE_TARGET("avx2")
+void convert_bgr555_to_bgra8_avx2(const uint16_t* source, uint8_t* destination,
+                                  size_t count) {
+    const __m256i mask = _mm256_set1_epi16(0x1F);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i pixels =
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+        __m256i red = expand_5_avx2(_mm256_and_si256(pixels, mask));
+        __m256i green =
+                expand_5_avx2(_mm256_and_si256(_mm256_srli_epi16(pixels, 5), mask));
+        __m256i blue =
+                expand_5_avx2(_mm256_and_si256(_mm256_srli_epi16(pixels, 10), mask));
+        store_bgra8_avx2(destination, blue, green, red);
+        destination += 64;
+    }
+
+    convert_bgr555_to_bgra8_sse2(source + i, destination, count - i);
+}
+
+MASEYA_VKBASE_TARGET("avx2")
+void convert_rgb565_to_bgra8_avx2(const uint16_t* source, uint8_t* destination,
+                                  size_t count) {
+    const __m256i mask_5 = _mm256_set1_epi16(0x1F);
+    const __m256i mask_6 = _mm256_set1_epi16(0x3F);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i pixels =
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+        __m256i blue = expand_5_avx2(_mm256_and_si256(pixels, mask_5));
+        __m256i green = _mm256_and_si256(_mm256_srli_epi16(pixels, 5), mask_6);
+        green = _mm256_or_si256(_mm256_slli_epi16(green, 2),
+                                _mm256_srli_epi16(green, 4));
+        __m256i red = expand_5_avx2(_mm256_srli_epi16(pixels, 11));
+        store_bgra8_avx2(destination, blue, green, red);
+        destination += 64;
+    }
+
+    convert_rgb565_to_bgra8_sse2(source + i, destination, count - i);
+}
+
+MASEYA_VKBASE_TARGET("avx2")
+__m256i premultiply_avx2(__m256i pixels) {
+    const __m256i alpha_shuffle = _mm256_setr_epi8(
+            6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15, 6, 7, 6, 7, 6, 7, 6,
+            7, 14, 15, 14, 15, 14, 15, 14, 15);
+    __m256i alpha = _mm256_shuffle_epi8(pixels, alpha_shuffle);
+    __m256i product = _mm256_add_epi16(_mm256_mullo_epi16(pixels, alpha),
+                                       _mm256_set1_epi16(128));
+    product = _mm256_srli_epi16(
+            _mm256_add_epi16(product, _mm256_srli_epi16(product, 8)), 8);
+    return _mm256_blend_epi16(product, pixels, 0x88);
+}
+
+MASEYA_VKBASE_TARGET("avx2")
+void premultiply_alpha_avx2(const uint8_t* source, uint8_t* destination,
+                            size_t count) {
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source));
+        __m256i low = premultiply_avx2(_mm256_unpacklo_epi8(pixels, zero));
+        __m256i high = premultiply_avx2(_mm256_unpackhi_epi8(pixels, zero));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination),
+                            _mm256_packus_epi16(low, high));
+        source += 32;
+        destination += 32;
+    }
+
+    premultiply_alpha_sse2(source, destination, count - i);
+}
+
+constexpr PixelKernels avx2_kernels{"avx2", swizzle_rgba8_bgra8_avx2,
+                                    convert_bgr555_to_bgra8_avx2,
+                                    convert_rgb565_to_bgra8_avx2,
+                                    premultiply_alpha_avx2};
+
+bool is_sse2_supported() {
+#if defined(_M_X64) || defined(__x86_64__)
+    return true;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return info[3] & 1 << 26;
+#else
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+bool is_avx2_supported() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+
+    // The OS also has to save the upper halves of the registers.
+    __cpuid(info, 1);
+    bool has_avx = (info[2] & 1 << 27) && (info[2] & 1 << 28);
+    if (!has_avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return info[1] & 1 << 5;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#elif defined(MASEYA_VKBASE_PIXEL_CONVERT_NEON)
+void swizzle_rgba8_bgra8_neon(const uint8_t* source, uint8_t* destination,
+                              size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t pixels = vld4q_u8(source);
+        uint8x16_t red = pixels.val[0];
+        pixels.val[0] = pixels.val[2];
+        pixels.val[2] = red;
+        vst4q_u8(destination, pixels);
+        source += 64;
+        destination += 64;
+    }
+
+    swizzle_rgba8_bgra8_scalar(source, destination, count - i);
+}
+
+uint8x8_t expand_5_neon(uint16x8_t x) {
+    return vmovn_u16(vorrq_u16(vshlq_n_u16(x, 3), vshrq_n_u16(x, 2)));
+}
+
+void convert_bgr555_to_bgra8_neon(const uint16_t* source, uint8_t* destination,
+                                  size_t count) {
+    const uint16x8_t mask = vdupq_n_u16(0x1F);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t pixels = vld1q_u16(source + i);
+        uint8x8x4_t result;
+        result.val[0] = expand_5_neon(vandq_u16(vshrq_n_u16(pixels, 10), mask));
+        result.val[1] = expand_5_neon(vandq_u16(vshrq_n_u16(pixels, 5), mask));
+        result.val[2] = expand_5_neon(vandq_u16(pixels, mask));
+        result.val[3] = vdup_n_u8(0xFF);
+        vst4_u8(destination, result);
+        destination += 32;
+    }
+
+    convert_bgr555_to_bgra8_scalar(source + i, destination, count - i);
+}
+
+void convert_rgb565_to_bgra8_neon(const uint16_t* source, uint8_t* destination,
+                                  size_t count) {
+    const uint16x8_t mask_5 = vdupq_n_u16(0x1F);
+    const uint16x8_t mask_6 = vdupq_n_u16(0x3F);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t pixels = vld1q_u16(source + i);
+        uint16x8_t green = vandq_u16(vshrq_n_u16(pixels, 5), mask_6);
+        uint8x8x4_t result;
+        result.val[0] = expand_5_neon(vandq_u16(pixels, mask_5));
+        green = vorrq_u16(vshlq_n_u16(green, 2), vshrq_n_u16(green, 4));
+        result.val[1] = vmovn_u16(green);
+        result.val[2] = expand_5_neon(vshrq_n_u16(pixels, 11));
+        result.val[3] = vdup_n_u8(0xFF);
+        vst4_u8(destination, result);
+        destination += 32;
+    }
+
+    convert_rgb565_to_bgra8_scalar(source + i, destination, count - i);
+}
+
+// Rounds the same way as divide_by_255.
+uint8x8_t multiply_neon(uint8x8_t color, uint8x8_t alpha) {
+    uint16x8_t product = vmull_u8(color, alpha);
+    return vraddhn_u16(product, vrshrq_n_u16(product, 8));
+}
+
+void premultiply_alpha_neon(const uint8_t* source, uint8_t* destination,
+                            size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint8x8x4_t pixels = vld4_u8(source);
+        for (int c = 0; c < 3; c++) {
+            pixels.val[c] = multiply_neon(pixels.val[c], pixels.val[3]);
+        }
+
+        vst4_u8(destination, pixels);
+        source += 32;
+        destination += 32;
+    }
+
+    premultiply_alpha_scalar(source, destination, count - i);
+}
+
+constexpr PixelKernels neon_kernels{"neon", swizzle_rgba8_bgra8_neon,
+                                    convert_bgr555_to_bgra8_neon,
+                                    convert_rgb565_to_bgra8_neon,
+                                    premultiply_alpha_neon};
+#endif
+
+const PixelKernels& get_kernels() {
+#if defined(MASEYA_VKBASE_PIXEL_CONVERT_X86)
+    static const PixelKernels& kernels = is_avx2_supported()   ? avx2_kernels
+                                         : is_sse2_supported() ? sse2_kernels
+                                                               : scalar_kernels;
+    return kernels;
+#elif defined(MASEYA_VKBASE_PIXEL_CONVERT_NEON)
+    return neon_kernels;
+#else
+    return scalar_kernels;
+#endif
+}
+
+// With eight bit channels a table is exact and beats evaluating the transfer function,
+// even in vector registers.
+using SrgbTable = std::array<uint8_t, 256>;
+
+SrgbTable create_srgb_table(bool encode) {
+    SrgbTable result;
+    for (int i = 0; i < 256; i++) {
+        double x = i / 255.0;
+        double y;
+        if (encode) {
+            y = x <= 0.0031308 ? x * 12.92 : 1.055 * std::pow(x, 1 / 2.4) - 0.055;
+        } else {
+            y = x <= 0.04045 ? x / 12.92 : std::pow((x + 0.055) / 1.055, 2.4);
+        }
+
+        result[i] = static_cast<uint8_t>(std::lround(y * 255));
+    }
+
+    return result;
+}
+
+void apply_srgb_table(const SrgbTable& table, const void* source, void* destination,
+                      size_t count) {
+    auto in = static_cast<const uint8_t*>(source);
+    auto out = static_cast<uint8_t*>(destination);
+    for (size_t i = 0; i < count; i++, in += 4, out += 4) {
+        uint8_t alpha = in[3];
+        out[0] = table[in[0]];
+        out[1] = table[in[1]];
+        out[2] = table[in[2]];
+        out[3] = alpha;
+    }
+}
+}  // namespace
+
+void swizzle_rgba8_bgra8(const void* source, void* destination, size_t count) {
+    get_kernels().swizzle_rgba8_bgra8(static_cast<const uint8_t*>(source),
+                                      static_cast<uint8_t*>(destination), count);
+}
+
+void convert_bgr555_to_bgra8(const uint16_t* source, void* destination, size_t count) {
+    get_kernels().convert_bgr555_to_bgra8(source, static_cast<uint8_t*>(destination),
+                                          count);
+}
+
+void convert_rgb565_to_bgra8(const uint16_t* source, void* destination, size_t count) {
+    get_kernels().convert_rgb565_to_bgra8(source, static_cast<uint8_t*>(destination),
+                                          count);
+}
+
+void premultiply_alpha(const void* source, void* destination, size_t count) {
+    get_kernels().premultiply_alpha(static_cast<const uint8_t*>(source),
+                                    static_cast<uint8_t*>(destination), count);
+}
+
+void encode_srgb(const void* source, void* destination, size_t count) {
+    static const SrgbTable table = create_srgb_table(true);
+    apply_srgb_table(table, source, destination, count);
+}
+
+void decode_srgb(const void* source, void* destination, size_t count) {
+    static const SrgbTable table = create_srgb_table(false);
+    apply_srgb_table(table, source, destination, count);
+}
+
+const char* get_pixel_convert_isa() { return get_kernels().isa; }
+}  // namespace maseya::vkbase
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace maseya::vkbase {
+// Pixel conversions for filling staging memory, such as turning StbImage's RGBA8 or an
+// emulator's 16 bit framebuffer into preferred_surface_format. Each converts count
+// pixels, writing the destination front to back so that it can be write-combined
+// mapped memory. Conversions that keep the pixel size may be done in place, but the
+// source and destination must not otherwise overlap.
+//
+// The first call picks the fastest implementation the CPU supports: AVX2 or SSE2 on
+// x86, NEON on ARM, and plain C++ everywhere else.
+
+// Swaps the red and blue channels, which converts RGBA8 to BGRA8 and back.
+void swizzle_rgba8_bgra8(const void* source, void* destination, size_t count);
+
+// Expands 0bbbbbgggggrrrrr pixels to opaque BGRA8.
+void convert_bgr555_to_bgra8(const uint16_t* source, void* destination, size_t count);
+
+// Expands rrrrrggggggbbbbb pixels to opaque BGRA8.
+void convert_rgb565_to_bgra8(const uint16_t* source, void* destination, size_t count);
+
+// Scales the color channels of RGBA8 or BGRA8 pixels by their alpha.
+void premultiply_alpha(const void* source, void* destination, size_t count);
+
+// Convert the color channels of RGBA8 or BGRA8 pixels from linear to sRGB encoding and
+// back. Alpha is left as is.
+void encode_srgb(const void* source, void* destination, size_t count);
+void decode_srgb(const void* source, void* destination, size_t count);
+
+// "avx2", "sse2", "neon" or "scalar".
+const char* get_pixel_convert_isa();
+}  // namespace maseya::vkbase
@@ -2,15 +2,22 @@
 
 namespace maseya::vkbase {
 std::string read_file(const char* path) {
-    std::ifstream file(path, std::ios::ate);
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file) {
+        throw InvalidPathError("Could not open file.", path);
+    }
+
     std::streamsize size = file.tellg();
-    if (size == 0) return {};
+    if (size <= 0) {
+        return {};
+    }
 
-    std::string result(static_cast<size_t>(size), ' ');
+    std::string result(static_cast<size_t>(size), '\0');
     file.seekg(0);
     file.read(result.data(), size);
-    file.close();
 
+    // The file may have been truncated since its size was taken.
+    result.resize(static_cast<size_t>(file.gcount()));
     return result;
 }
 }  // namespace maseya::vkbase
\ No newline at end of file
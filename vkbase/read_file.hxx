@@ -4,29 +4,44 @@
 #include <string>
 #include <vector>
 
+#include "VulkanError.hxx"
+
 namespace maseya::vkbase {
+// These read the file with ordinary reads rather than mapping it, so a file that is
+// truncated or rewritten while it is read, such as a shader source open in an editor,
+// yields short or mixed contents, and the editor is never kept from saving it. Use
+// MappedFile for files that do not change while the program runs, such as archives
+// and SPIR-V.
 template <class T>
 std::vector<T> read_file(const char* path) {
     std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file) {
+        throw InvalidPathError("Could not open file.", path);
+    }
+
     std::streamsize size = file.tellg();
-    if (size == 0) {
+    if (size <= 0) {
         return {};
     }
 
     std::vector<T> result(static_cast<size_t>(1 + ((size - 1) / sizeof(T))));
     file.seekg(0);
     file.read(reinterpret_cast<char*>(result.data()), size);
-    file.close();
 
+    // The file may have been truncated since its size was taken.
+    size = file.gcount();
+    result.resize(static_cast<size_t>((size + sizeof(T) - 1) / sizeof(T)));
     return result;
 }
 
 template <class T>
 std::vector<T> read_file(const std::string& path) {
-    return read_file(path.c_str());
+    return read_file<T>(path.c_str());
 }
 
 std::string read_file(const char* path);
 
-std::string read_file(const std::string& path) { return read_file(path.c_str()); }
+inline std::string read_file(const std::string& path) {
+    return read_file(path.c_str());
+}
 }  // namespace maseya::vkbase
@@ -5,11 +5,16 @@
 namespace maseya::vkbase {
 namespace fs = std::filesystem;
 
+Compiler& get_default_compiler() {
+    static Compiler compiler;
+    return compiler;
+}
+
 std::vector<uint32_t> compile_shader(const std::string& source, ShaderKind shader_kind,
                                      const std::string& file_name,
                                      const std::vector<Define>& defines) {
-    return Compiler().compile_shader(source, file_name.empty() ? "shader" : file_name,
-                                     shader_kind, defines);
+    return get_default_compiler().compile_shader(
+            source, file_name.empty() ? "shader" : file_name, shader_kind, defines);
 }
 
 void to_lower(std::string& str) {
@@ -32,6 +37,8 @@ ShaderKind get_shader_kind_from_file_name(const std::string& path) {
         return ShaderKind::VertexShader;
     } else if (ext == ".frag" || ext == ".fs") {
         return ShaderKind::FragmentShader;
+    } else if (ext == ".comp" || ext == ".cs") {
+        return ShaderKind::ComputeShader;
     } else {
         throw InvalidPathError("Could not infer shader kind from path name.", path);
     }
@@ -46,6 +53,6 @@ std::vector<uint32_t> compile_shader_from_file(const std::string& path,
 std::vector<uint32_t> compile_shader_from_file(const std::string& path,
                                                ShaderKind shader_kind,
                                                const std::vector<Define>& defines) {
-    return Compiler().compile_shader(path, shader_kind, defines);
+    return get_default_compiler().compile_shader(path, shader_kind, defines);
 }
 }  // namespace maseya::vkbase
\ No newline at end of file
@@ -7,6 +7,10 @@
 #include "Compiler.hxx"
 
 namespace maseya::vkbase {
+// The compiler shared by the functions below. Set a SPIR-V cache on it before
+// compiling to have them skip shaderc for unchanged shaders.
+Compiler& get_default_compiler();
+
 std::vector<uint32_t> compile_shader(const std::string& source, ShaderKind shader_kind,
                                      const std::string& file_name,
                                      const std::vector<Define>& defines = {});
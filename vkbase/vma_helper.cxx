@@ -44,31 +44,25 @@ void destroy_buffer(VmaAllocator allocator, vma_buffer& buffer) {
     vmaDestroyBuffer(allocator, buffer.buffer, buffer.allocation);
 }
 
-vma_image create_image(VmaAllocator allocator, VkImageType image_type,
-                       const VkExtent2D extent, VkFormat format) {
+vma_image create_image(VmaAllocator allocator, const ImageDesc& desc) {
     VkImageCreateInfo image_info{};
     image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-    image_info.imageType = image_type;
-    image_info.extent.width = extent.width;
-    image_info.extent.height = extent.height;
-    image_info.extent.depth = 1;
-    image_info.mipLevels = 1;
-    image_info.arrayLayers = 1;
-    image_info.format = format;
-    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_info.flags = desc.flags;
+    image_info.imageType = desc.image_type;
+    image_info.extent = desc.extent;
+    image_info.mipLevels = desc.mip_levels;
+    image_info.arrayLayers = desc.array_layers;
+    image_info.format = desc.format;
+    image_info.tiling = desc.tiling;
     image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    image_info.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
-                       VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
-    if (image_type == VK_IMAGE_TYPE_2D) {
-        image_info.usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
-    }
+    image_info.usage = desc.usage;
 
     // TODO(nrg): Look into sharing mode.
     image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_info.samples = desc.samples;
 
     VmaAllocationCreateInfo allocation_info{};
-    allocation_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    allocation_info.usage = desc.memory_usage;
 
     vma_image result{};
     assert_result(vmaCreateImage(allocator, &image_info, &allocation_info,
@@ -77,13 +71,30 @@ vma_image create_image(VmaAllocator allocator, VkImageType image_type,
     return result;
 }
 
+namespace {
+vma_image create_color_image(VmaAllocator allocator, VkImageType image_type,
+                             const VkExtent2D extent, VkFormat format) {
+    ImageDesc desc;
+    desc.image_type = image_type;
+    desc.format = format;
+    desc.extent = {extent.width, extent.height, 1};
+    desc.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
+                 VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    if (image_type == VK_IMAGE_TYPE_2D) {
+        desc.usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    }
+
+    return create_image(allocator, desc);
+}
+}  // namespace
+
 vma_image create_image(VmaAllocator allocator, uint32_t extent, VkFormat format) {
-    return create_image(allocator, VK_IMAGE_TYPE_1D, {extent, 1}, format);
+    return create_color_image(allocator, VK_IMAGE_TYPE_1D, {extent, 1}, format);
 }
 
 vma_image create_image(VmaAllocator allocator, const VkExtent2D& extent,
                        VkFormat format) {
-    return create_image(allocator, VK_IMAGE_TYPE_2D, extent, format);
+    return create_color_image(allocator, VK_IMAGE_TYPE_2D, extent, format);
 }
 
 void destroy_image(VmaAllocator allocator, vma_image& image) {
@@ -3,6 +3,7 @@
 #include <vma/vk_mem_alloc.h>
 #include <vulkan/vulkan_core.h>
 
+#include "ImageDesc.hxx"
 #include "vulkan_helper.hxx"
 
 namespace maseya::vkbase {
@@ -36,6 +37,9 @@ vma_buffer create_buffer(VmaAllocator allocator, VkDeviceSize size,
 
 void destroy_buffer(VmaAllocator allocator, vma_buffer& buffer);
 
+vma_image create_image(VmaAllocator allocator, const ImageDesc& desc);
+
+// These keep the usage of a color attachment that is also copied to and from.
 vma_image create_image(VmaAllocator allocator, uint32_t extent, VkFormat format);
 
 vma_image create_image(VmaAllocator allocator, const VkExtent2D& extent,
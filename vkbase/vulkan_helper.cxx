@@ -3,10 +3,12 @@
 #include <algorithm>
 #include <cctype>
 #include <filesystem>
+#include <numeric>
 #include <unordered_map>
 #include <unordered_set>
 
 #include "Compiler.hxx"
+#include "PipelineReport.hxx"
 #include "VulkanError.hxx"
 
 namespace maseya::vkbase {
@@ -101,6 +103,17 @@ VkInstance create_instance(const std::string& application_name,
     std::vector<const char*> required_extensions = get_required_instance_extensions();
     assert_instance_extensions_supported(required_extensions);
 
+    // Device extension features can only be enabled on a Vulkan 1.0 instance through
+    // this extension, so enable it whenever it is available.
+    std::vector<const char*> optional_extensions({
+            VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME,
+    });
+    if (get_unsupported_instance_extensions(optional_extensions).empty()) {
+        required_extensions.insert(required_extensions.end(),
+                                   optional_extensions.begin(),
+                                   optional_extensions.end());
+    }
+
     // Next we fill out some app info for Vulkan's sake.
     VkApplicationInfo app_info{};
     app_info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
@@ -254,11 +267,16 @@ std::optional<uint32_t> get_transfer_queue_family_index(
 }
 
 VkDevice create_device(VkPhysicalDevice physical_device,
-                       const std::unordered_set<uint32_t>& queue_family_indices) {
+                       const std::unordered_set<uint32_t>& queue_family_indices,
+                       const std::vector<const char*>& optional_extensions,
+                       const void* next,
+                       const VkPhysicalDeviceFeatures* enabled_features) {
     std::vector<const char*> required_layers = get_required_instance_layers();
     assert_instance_layers_supported(required_layers);
 
     std::vector<const char*> required_extensions = get_required_device_extensions();
+    required_extensions.insert(required_extensions.end(), optional_extensions.begin(),
+                               optional_extensions.end());
     assert_device_extensions_supported(physical_device, required_extensions);
 
     // Although we have a graphics queue and presentation queue, it's possible that they
@@ -277,16 +295,13 @@ VkDevice create_device(VkPhysicalDevice physical_device,
         queue_create_infos.push_back(queue_create_info);
     }
 
-    // We aren't requesting any physical device features, but we still require a valid
-    // instance of it to create a device.
-    VkPhysicalDeviceFeatures enabled_features{};
-
     // Populate info for creating device.
     VkDeviceCreateInfo create_info{};
     create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    create_info.pNext = next;
     create_info.queueCreateInfoCount = static_cast<uint32_t>(queue_create_infos.size());
     create_info.pQueueCreateInfos = queue_create_infos.data();
-    create_info.pEnabledFeatures = &enabled_features;
+    create_info.pEnabledFeatures = enabled_features;
     create_info.enabledExtensionCount =
             static_cast<uint32_t>(required_extensions.size());
     create_info.ppEnabledExtensionNames = required_extensions.data();
@@ -444,9 +459,38 @@ VkShaderModule create_shader_module(VkDevice device, const uint32_t* code,
     return result;
 }
 
+VkPipelineCache create_pipeline_cache(VkDevice device, const void* initial_data,
+                                      size_t initial_data_size) {
+    VkPipelineCacheCreateInfo create_info{};
+    create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    create_info.initialDataSize = initial_data_size;
+    create_info.pInitialData = initial_data;
+
+    VkPipelineCache result;
+    assert_result(vkCreatePipelineCache(device, &create_info, nullptr, &result));
+
+    return result;
+}
+
+std::vector<char> get_pipeline_cache_data(VkDevice device,
+                                          VkPipelineCache pipeline_cache) {
+    size_t size;
+    assert_result(vkGetPipelineCacheData(device, pipeline_cache, &size, nullptr));
+
+    std::vector<char> result(size);
+    assert_result(
+            vkGetPipelineCacheData(device, pipeline_cache, &size, result.data()));
+    result.resize(size);
+
+    return result;
+}
+
 VkPipeline create_graphics_pipeline(
-        VkDevice device, VkRenderPass render_pass, VkPipelineLayout pipeline_layout,
-        VkShaderModule vertex_shader, VkShaderModule fragment_shader,
+        VkDevice device, VkPipelineCache pipeline_cache, VkRenderPass render_pass,
+        VkPipelineLayout pipeline_layout, VkShaderModule vertex_shader,
+        const VkSpecializationInfo* vertex_specialization_info,
+        VkShaderModule fragment_shader,
+        const VkSpecializationInfo* fragment_specialization_info,
         const VkVertexInputBindingDescription* vertex_binding_descriptions,
         uint32_t vertex_binding_description_count,
         const VkVertexInputAttributeDescription* vertex_attribute_descriptions,
@@ -457,11 +501,13 @@ VkPipeline create_graphics_pipeline(
     shader_stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
     shader_stages[0].module = vertex_shader;
     shader_stages[0].pName = "main";
+    shader_stages[0].pSpecializationInfo = vertex_specialization_info;
 
     shader_stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     shader_stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
     shader_stages[1].module = fragment_shader;
     shader_stages[1].pName = "main";
+    shader_stages[1].pSpecializationInfo = fragment_specialization_info;
 
     VkPipelineVertexInputStateCreateInfo vertex_state{};
     vertex_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -538,10 +584,39 @@ VkPipeline create_graphics_pipeline(
     create_info.subpass = 0;
     create_info.basePipelineIndex = -1;
 
+    PipelineFeedbackRecorder feedback_recorder(device, shader_stages, 2);
+    feedback_recorder.attach(create_info);
+
     VkPipeline result;
-    assert_result(vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &create_info,
+    assert_result(vkCreateGraphicsPipelines(device, pipeline_cache, 1, &create_info,
                                             nullptr, &result));
 
+    feedback_recorder.record(result, VK_PIPELINE_BIND_POINT_GRAPHICS);
+    return result;
+}
+
+VkPipeline create_compute_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                   VkPipelineLayout pipeline_layout,
+                                   VkShaderModule compute_shader,
+                                   const VkSpecializationInfo* specialization_info) {
+    VkComputePipelineCreateInfo create_info{};
+    create_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    create_info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    create_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    create_info.stage.module = compute_shader;
+    create_info.stage.pName = "main";
+    create_info.stage.pSpecializationInfo = specialization_info;
+    create_info.layout = pipeline_layout;
+    create_info.basePipelineIndex = -1;
+
+    PipelineFeedbackRecorder feedback_recorder(device, &create_info.stage, 1);
+    feedback_recorder.attach(create_info);
+
+    VkPipeline result;
+    assert_result(vkCreateComputePipelines(device, pipeline_cache, 1, &create_info,
+                                           nullptr, &result));
+
+    feedback_recorder.record(result, VK_PIPELINE_BIND_POINT_COMPUTE);
     return result;
 }
 
@@ -640,7 +715,8 @@ void end_command(VkCommandBuffer command_buffer) {
 }
 
 void transition_layout(VkCommandBuffer command_buffer, VkImage image,
-                       VkImageLayout old_layout, VkImageLayout new_layout) {
+                       VkImageLayout old_layout, VkImageLayout new_layout,
+                       const VkImageSubresourceRange& subresource_range) {
     if (new_layout == old_layout) {
         return;
     }
@@ -655,11 +731,7 @@ void transition_layout(VkCommandBuffer command_buffer, VkImage image,
     barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 
     barrier.image = image;
-    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
-    barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
+    barrier.subresourceRange = subresource_range;
 
     VkPipelineStageFlags source_stage;
     VkPipelineStageFlags destination_stage;
@@ -677,6 +749,11 @@ void transition_layout(VkCommandBuffer command_buffer, VkImage image,
             source_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
             break;
 
+        case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            source_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+            break;
+
         case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
             barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
             source_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
@@ -688,6 +765,12 @@ void transition_layout(VkCommandBuffer command_buffer, VkImage image,
             source_stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
             break;
 
+        case VK_IMAGE_LAYOUT_GENERAL:
+            barrier.srcAccessMask =
+                    VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            source_stage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+            break;
+
         case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
             barrier.srcAccessMask = 0;
 
@@ -721,6 +804,12 @@ void transition_layout(VkCommandBuffer command_buffer, VkImage image,
             destination_stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
             break;
 
+        case VK_IMAGE_LAYOUT_GENERAL:
+            barrier.dstAccessMask =
+                    VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            destination_stage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+            break;
+
         case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
             barrier.dstAccessMask = VK_ACCESS_NONE_KHR;
 
@@ -736,9 +825,189 @@ void transition_layout(VkCommandBuffer command_buffer, VkImage image,
                          0, nullptr, 1, &barrier);
 }
 
+bool is_linear_blit_supported(VkPhysicalDevice physical_device, VkFormat format) {
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(physical_device, format, &properties);
+
+    VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT |
+                                    VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                    VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    return (properties.optimalTilingFeatures & required) == required;
+}
+
+void generate_mipmaps(VkCommandBuffer command_buffer, VkImage image,
+                      const VkExtent2D& extent, uint32_t mip_levels,
+                      uint32_t array_layers, VkFilter filter,
+                      VkImageLayout final_layout,
+                      VkPipelineStageFlags destination_stage,
+                      VkAccessFlags destination_access) {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = array_layers;
+
+    int32_t width = static_cast<int32_t>(extent.width);
+    int32_t height = static_cast<int32_t>(extent.height);
+    for (uint32_t level = 1; level < mip_levels; level++) {
+        // The previous level was just written, so make it the source of this blit.
+        barrier.subresourceRange.baseMipLevel = level - 1;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr,
+                             1, &barrier);
+
+        int32_t next_width = std::max(width / 2, 1);
+        int32_t next_height = std::max(height / 2, 1);
+
+        VkImageBlit blit{};
+        blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, array_layers};
+        blit.srcOffsets[1] = {width, height, 1};
+        blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, array_layers};
+        blit.dstOffsets[1] = {next_width, next_height, 1};
+        vkCmdBlitImage(command_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, filter);
+
+        width = next_width;
+        height = next_height;
+    }
+
+    // Every level but the last was read as a blit source, and the last was written.
+    // Move them all to the final layout with one barrier.
+    VkImageMemoryBarrier final_barriers[2] = {barrier, barrier};
+    uint32_t final_barrier_count = 0;
+    if (mip_levels > 1) {
+        VkImageMemoryBarrier& sources = final_barriers[final_barrier_count++];
+        sources.subresourceRange.baseMipLevel = 0;
+        sources.subresourceRange.levelCount = mip_levels - 1;
+        sources.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        sources.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    }
+
+    VkImageMemoryBarrier& last = final_barriers[final_barrier_count++];
+    last.subresourceRange.baseMipLevel = mip_levels - 1;
+    last.subresourceRange.levelCount = 1;
+    last.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    last.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    for (uint32_t i = 0; i < final_barrier_count; i++) {
+        final_barriers[i].newLayout = final_layout;
+        final_barriers[i].dstAccessMask = destination_access;
+    }
+
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         destination_stage, 0, 0, nullptr, 0, nullptr,
+                         final_barrier_count, final_barriers);
+}
+
+void memory_barrier(VkCommandBuffer command_buffer, VkPipelineStageFlags source_stage,
+                    VkAccessFlags source_access, VkPipelineStageFlags destination_stage,
+                    VkAccessFlags destination_access) {
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = source_access;
+    barrier.dstAccessMask = destination_access;
+
+    vkCmdPipelineBarrier(command_buffer, source_stage, destination_stage, 0, 1,
+                         &barrier, 0, nullptr, 0, nullptr);
+}
+
+void buffer_memory_barrier(VkCommandBuffer command_buffer, VkBuffer buffer,
+                           VkDeviceSize offset, VkDeviceSize size,
+                           VkPipelineStageFlags source_stage,
+                           VkAccessFlags source_access,
+                           VkPipelineStageFlags destination_stage,
+                           VkAccessFlags destination_access) {
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = source_access;
+    barrier.dstAccessMask = destination_access;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = buffer;
+    barrier.offset = offset;
+    barrier.size = size;
+
+    vkCmdPipelineBarrier(command_buffer, source_stage, destination_stage, 0, 0, nullptr,
+                         1, &barrier, 0, nullptr);
+}
+
+void image_ownership_barrier(VkCommandBuffer command_buffer, VkImage image,
+                             VkImageLayout old_layout, VkImageLayout new_layout,
+                             uint32_t source_queue_family_index,
+                             uint32_t destination_queue_family_index,
+                             VkPipelineStageFlags source_stage,
+                             VkAccessFlags source_access,
+                             VkPipelineStageFlags destination_stage,
+                             VkAccessFlags destination_access) {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = source_access;
+    barrier.dstAccessMask = destination_access;
+    barrier.oldLayout = old_layout;
+    barrier.newLayout = new_layout;
+    barrier.srcQueueFamilyIndex = source_queue_family_index;
+    barrier.dstQueueFamilyIndex = destination_queue_family_index;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+
+    vkCmdPipelineBarrier(command_buffer, source_stage, destination_stage, 0, 0, nullptr,
+                         0, nullptr, 1, &barrier);
+}
+
+uint32_t get_texel_size(VkFormat format) noexcept {
+    switch (format) {
+        case VK_FORMAT_R8_UNORM:
+        case VK_FORMAT_R8_SRGB:
+            return 1;
+
+        case VK_FORMAT_R8G8_UNORM:
+        case VK_FORMAT_R5G6B5_UNORM_PACK16:
+        case VK_FORMAT_B5G6R5_UNORM_PACK16:
+        case VK_FORMAT_R5G5B5A1_UNORM_PACK16:
+        case VK_FORMAT_B5G5R5A1_UNORM_PACK16:
+        case VK_FORMAT_A1R5G5B5_UNORM_PACK16:
+        case VK_FORMAT_R16_UNORM:
+        case VK_FORMAT_R16_SFLOAT:
+            return 2;
+
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+        case VK_FORMAT_A8B8G8R8_UNORM_PACK32:
+        case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+        case VK_FORMAT_R32_SFLOAT:
+            return 4;
+
+        case VK_FORMAT_R16G16B16A16_UNORM:
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+            return 8;
+
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+            return 16;
+
+        default:
+            return 0;
+    }
+}
+
 void copy_buffer_to_image(VkCommandBuffer command_buffer, VkBuffer buffer,
-                          VkImage image, uint32_t width, uint32_t height) {
+                          VkImage image, uint32_t width, uint32_t height,
+                          VkDeviceSize buffer_offset) {
     VkBufferImageCopy region{};
+    region.bufferOffset = buffer_offset;
     region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     region.imageSubresource.layerCount = 1;
     region.imageExtent = {width, height, 1};
@@ -747,6 +1016,128 @@ void copy_buffer_to_image(VkCommandBuffer command_buffer, VkBuffer buffer,
                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
 }
 
+void copy_buffer_to_image(VkCommandBuffer command_buffer, VkBuffer buffer,
+                          VkImage image,
+                          const std::vector<VkBufferImageCopy>& regions) {
+    if (regions.empty()) {
+        return;
+    }
+
+    vkCmdCopyBufferToImage(command_buffer, buffer, image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(regions.size()), regions.data());
+}
+
+namespace {
+// Merging compares every pair of rectangles and may take a pass per merge, so its
+// cost grows with the cube of the count. Past this many, the rectangles are replaced
+// by their bounding box instead.
+constexpr size_t max_merged_dirty_rect_count = 64;
+}  // namespace
+
+void merge_dirty_rects(std::vector<VkRect2D>& rects, const VkExtent2D& extent) {
+    for (auto& rect : rects) {
+        int64_t left = std::max<int64_t>(rect.offset.x, 0);
+        int64_t top = std::max<int64_t>(rect.offset.y, 0);
+        int64_t right = std::min<int64_t>(int64_t(rect.offset.x) + rect.extent.width,
+                                          extent.width);
+        int64_t bottom = std::min<int64_t>(
+                int64_t(rect.offset.y) + rect.extent.height, extent.height);
+        rect.offset = {static_cast<int32_t>(left), static_cast<int32_t>(top)};
+        rect.extent = {static_cast<uint32_t>(std::max<int64_t>(right - left, 0)),
+                       static_cast<uint32_t>(std::max<int64_t>(bottom - top, 0))};
+    }
+
+    rects.erase(std::remove_if(rects.begin(), rects.end(),
+                               [](const VkRect2D& rect) {
+                                   return rect.extent.width == 0 ||
+                                          rect.extent.height == 0;
+                               }),
+                rects.end());
+
+    if (rects.size() > max_merged_dirty_rect_count) {
+        VkRect2D bounds = rects.front();
+        int32_t right = bounds.offset.x + static_cast<int32_t>(bounds.extent.width);
+        int32_t bottom = bounds.offset.y + static_cast<int32_t>(bounds.extent.height);
+        for (const auto& rect : rects) {
+            bounds.offset.x = std::min(bounds.offset.x, rect.offset.x);
+            bounds.offset.y = std::min(bounds.offset.y, rect.offset.y);
+            right = std::max(right,
+                             rect.offset.x + static_cast<int32_t>(rect.extent.width));
+            bottom = std::max(bottom,
+                              rect.offset.y + static_cast<int32_t>(rect.extent.height));
+        }
+
+        bounds.extent = {static_cast<uint32_t>(right - bounds.offset.x),
+                         static_cast<uint32_t>(bottom - bounds.offset.y)};
+        rects.assign(1, bounds);
+        return;
+    }
+
+    // Merging can make a rectangle overlap one it was already checked against, so
+    // this repeats until nothing changes.
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (size_t i = 0; i < rects.size(); i++) {
+            for (size_t j = i + 1; j < rects.size();) {
+                VkRect2D& a = rects[i];
+                const VkRect2D& b = rects[j];
+                int32_t a_right = a.offset.x + static_cast<int32_t>(a.extent.width);
+                int32_t a_bottom = a.offset.y + static_cast<int32_t>(a.extent.height);
+                int32_t b_right = b.offset.x + static_cast<int32_t>(b.extent.width);
+                int32_t b_bottom = b.offset.y + static_cast<int32_t>(b.extent.height);
+
+                bool overlaps = a.offset.x < b_right && b.offset.x < a_right &&
+                                a.offset.y < b_bottom && b.offset.y < a_bottom;
+                bool same_columns = a.offset.x == b.offset.x &&
+                                    a.extent.width == b.extent.width &&
+                                    (a_bottom == b.offset.y || b_bottom == a.offset.y);
+                bool same_rows = a.offset.y == b.offset.y &&
+                                 a.extent.height == b.extent.height &&
+                                 (a_right == b.offset.x || b_right == a.offset.x);
+                if (!overlaps && !same_columns && !same_rows) {
+                    j++;
+                    continue;
+                }
+
+                int32_t left = std::min(a.offset.x, b.offset.x);
+                int32_t top = std::min(a.offset.y, b.offset.y);
+                a.offset = {left, top};
+                a.extent = {static_cast<uint32_t>(std::max(a_right, b_right) - left),
+                            static_cast<uint32_t>(std::max(a_bottom, b_bottom) - top)};
+                rects.erase(rects.begin() + j);
+                merged = true;
+            }
+        }
+    }
+}
+
+VkDeviceSize pack_image_regions(const std::vector<VkRect2D>& rects, uint32_t texel_size,
+                                VkDeviceSize buffer_offset,
+                                std::vector<VkBufferImageCopy>& regions) {
+    // Buffer offsets must be a multiple of both 4 and the texel size. Texel sizes
+    // such as 3 or 6 are not powers of two, so this cannot be a mask.
+    VkDeviceSize alignment = std::lcm<VkDeviceSize>(texel_size, 4);
+
+    regions.clear();
+    for (const auto& rect : rects) {
+        buffer_offset = (buffer_offset + alignment - 1) / alignment * alignment;
+
+        VkBufferImageCopy region{};
+        region.bufferOffset = buffer_offset;
+        region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+        region.imageOffset = {rect.offset.x, rect.offset.y, 0};
+        region.imageExtent = {rect.extent.width, rect.extent.height, 1};
+        regions.push_back(region);
+
+        buffer_offset +=
+                VkDeviceSize(rect.extent.width) * rect.extent.height * texel_size;
+    }
+
+    return buffer_offset;
+}
+
 void copy_image_to_buffer(VkCommandBuffer command_buffer, VkImage image, uint32_t width,
                           uint32_t height, VkBuffer buffer) {
     VkBufferImageCopy region{};
@@ -759,7 +1150,7 @@ void copy_image_to_buffer(VkCommandBuffer command_buffer, VkImage image, uint32_
 }
 
 VkImageView create_image_view(VkDevice device, VkImage image, VkFormat format,
-                              VkImageAspectFlags aspect_mask,
+                              const VkImageSubresourceRange& subresource_range,
                               VkImageViewType image_view_type) {
     VkImageViewCreateInfo create_info{};
     create_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -770,11 +1161,7 @@ VkImageView create_image_view(VkDevice device, VkImage image, VkFormat format,
     create_info.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
     create_info.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
     create_info.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
-    create_info.subresourceRange.aspectMask = aspect_mask;
-    create_info.subresourceRange.baseMipLevel = 0;
-    create_info.subresourceRange.levelCount = 1;
-    create_info.subresourceRange.baseArrayLayer = 0;
-    create_info.subresourceRange.layerCount = 1;
+    create_info.subresourceRange = subresource_range;
 
     VkImageView result;
     assert_result(vkCreateImageView(device, &create_info, nullptr, &result));
@@ -782,9 +1169,11 @@ VkImageView create_image_view(VkDevice device, VkImage image, VkFormat format,
     return result;
 }
 
-VkSampler create_sampler(VkDevice device, VkFilter mag_filter, VkFilter min_filter,
-                         VkSamplerAddressMode mode_u, VkSamplerAddressMode mode_v,
-                         VkSamplerAddressMode mode_w) {
+namespace {
+VkSamplerCreateInfo get_sampler_create_info(VkFilter mag_filter, VkFilter min_filter,
+                                            VkSamplerAddressMode mode_u,
+                                            VkSamplerAddressMode mode_v,
+                                            VkSamplerAddressMode mode_w) {
     VkSamplerCreateInfo create_info{};
     create_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
     create_info.magFilter = mag_filter;
@@ -801,6 +1190,29 @@ VkSampler create_sampler(VkDevice device, VkFilter mag_filter, VkFilter min_filt
     create_info.mipLodBias = 0.0f;
     create_info.minLod = 0.0f;
     create_info.maxLod = 0.0f;
+    return create_info;
+}
+}  // namespace
+
+VkSampler create_sampler(VkDevice device, VkFilter mag_filter, VkFilter min_filter,
+                         VkSamplerAddressMode mode_u, VkSamplerAddressMode mode_v,
+                         VkSamplerAddressMode mode_w) {
+    VkSamplerCreateInfo create_info =
+            get_sampler_create_info(mag_filter, min_filter, mode_u, mode_v, mode_w);
+
+    VkSampler result;
+    assert_result(vkCreateSampler(device, &create_info, nullptr, &result));
+
+    return result;
+}
+
+VkSampler create_sampler(VkDevice device, VkFilter mag_filter, VkFilter min_filter,
+                         VkSamplerMipmapMode mipmap_mode,
+                         VkSamplerAddressMode address_mode, float max_lod) {
+    VkSamplerCreateInfo create_info = get_sampler_create_info(
+            mag_filter, min_filter, address_mode, address_mode, address_mode);
+    create_info.mipmapMode = mipmap_mode;
+    create_info.maxLod = max_lod;
 
     VkSampler result;
     assert_result(vkCreateSampler(device, &create_info, nullptr, &result));
@@ -82,6 +82,21 @@ FunctionPointer get_instance_proc_addr(VkInstance instance, const std::string& n
 #define GET_INSTANCE_PROC_ADDR(instance__, name__) \
     get_instance_proc_addr<PFN_##name__>(instance__, #name__)
 
+template <class FunctionPointer>
+FunctionPointer get_device_proc_addr(VkDevice device, const std::string& name) {
+    PFN_vkVoidFunction result = vkGetDeviceProcAddr(device, name.c_str());
+    if (!result) {
+        std::stringstream ss;
+        ss << "Could not find function: " << name;
+        throw VkBaseError(ss.str());
+    }
+
+    return reinterpret_cast<FunctionPointer>(result);
+}
+
+#define GET_DEVICE_PROC_ADDR(device__, name__) \
+    get_device_proc_addr<PFN_##name__>(device__, #name__)
+
 template <class UserCallback>
 VKAPI_ATTR VkBool32 VKAPI_CALL
 debug_callback(VkDebugUtilsMessageSeverityFlagBitsEXT message_severity,
@@ -263,8 +278,21 @@ std::optional<uint32_t> get_graphics_queue_family_index(
 std::optional<uint32_t> get_transfer_queue_family_index(
         VkPhysicalDevice physical_device, VkBool32 exclusive = VK_FALSE);
 
+// Optional extensions are enabled in addition to the required ones. The next pointer
+// is chained into VkDeviceCreateInfo, e.g. to enable extension features. The enabled
+// features may be null to enable none, and must be if next chains a
+// VkPhysicalDeviceFeatures2.
 VkDevice create_device(VkPhysicalDevice physical_device,
-                       const std::unordered_set<uint32_t>& queue_family_indices);
+                       const std::unordered_set<uint32_t>& queue_family_indices,
+                       const std::vector<const char*>& optional_extensions,
+                       const void* next = nullptr,
+                       const VkPhysicalDeviceFeatures* enabled_features = nullptr);
+
+inline VkDevice create_device(
+        VkPhysicalDevice physical_device,
+        const std::unordered_set<uint32_t>& queue_family_indices) {
+    return create_device(physical_device, queue_family_indices, {});
+}
 
 VkQueue get_queue(VkDevice device, uint32_t queue_family_index,
                   uint32_t queue_index = 0);
@@ -430,13 +458,69 @@ VkShaderModule create_shader_module(VkDevice device, const std::vector<T>& code)
                                 code.size() * sizeof(T));
 }
 
+VkPipelineCache create_pipeline_cache(VkDevice device,
+                                      const void* initial_data = nullptr,
+                                      size_t initial_data_size = 0);
+
+std::vector<char> get_pipeline_cache_data(VkDevice device,
+                                          VkPipelineCache pipeline_cache);
+
+// The specialization infos are optional and may be null for stages that have no
+// specialization constants. The pipeline cache may be VK_NULL_HANDLE.
 VkPipeline create_graphics_pipeline(
+        VkDevice device, VkPipelineCache pipeline_cache, VkRenderPass render_pass,
+        VkPipelineLayout pipeline_layout, VkShaderModule vertex_shader,
+        const VkSpecializationInfo* vertex_specialization_info,
+        VkShaderModule fragment_shader,
+        const VkSpecializationInfo* fragment_specialization_info,
+        const VkVertexInputBindingDescription* vertex_binding_descriptions,
+        uint32_t vertex_binding_description_count,
+        const VkVertexInputAttributeDescription* vertex_attribute_descriptions,
+        uint32_t vertex_attribute_description_count);
+
+inline VkPipeline create_graphics_pipeline(
+        VkDevice device, VkRenderPass render_pass, VkPipelineLayout pipeline_layout,
+        VkShaderModule vertex_shader,
+        const VkSpecializationInfo* vertex_specialization_info,
+        VkShaderModule fragment_shader,
+        const VkSpecializationInfo* fragment_specialization_info,
+        const VkVertexInputBindingDescription* vertex_binding_descriptions,
+        uint32_t vertex_binding_description_count,
+        const VkVertexInputAttributeDescription* vertex_attribute_descriptions,
+        uint32_t vertex_attribute_description_count) {
+    return create_graphics_pipeline(
+            device, VK_NULL_HANDLE, render_pass, pipeline_layout, vertex_shader,
+            vertex_specialization_info, fragment_shader, fragment_specialization_info,
+            vertex_binding_descriptions, vertex_binding_description_count,
+            vertex_attribute_descriptions, vertex_attribute_description_count);
+}
+
+inline VkPipeline create_graphics_pipeline(
         VkDevice device, VkRenderPass render_pass, VkPipelineLayout pipeline_layout,
         VkShaderModule vertex_shader, VkShaderModule fragment_shader,
         const VkVertexInputBindingDescription* vertex_binding_descriptions,
         uint32_t vertex_binding_description_count,
         const VkVertexInputAttributeDescription* vertex_attribute_descriptions,
-        uint32_t vertex_attribute_description_count);
+        uint32_t vertex_attribute_description_count) {
+    return create_graphics_pipeline(device, render_pass, pipeline_layout, vertex_shader,
+                                    nullptr, fragment_shader, nullptr,
+                                    vertex_binding_descriptions,
+                                    vertex_binding_description_count,
+                                    vertex_attribute_descriptions,
+                                    vertex_attribute_description_count);
+}
+
+inline VkPipeline create_graphics_pipeline(
+        VkDevice device, VkRenderPass render_pass, VkPipelineLayout pipeline_layout,
+        VkShaderModule vertex_shader,
+        const VkSpecializationInfo* vertex_specialization_info,
+        VkShaderModule fragment_shader,
+        const VkSpecializationInfo* fragment_specialization_info) {
+    return create_graphics_pipeline(device, render_pass, pipeline_layout, vertex_shader,
+                                    vertex_specialization_info, fragment_shader,
+                                    fragment_specialization_info, nullptr, 0, nullptr,
+                                    0);
+}
 
 inline VkPipeline create_graphics_pipeline(VkDevice device, VkRenderPass render_pass,
                                            VkPipelineLayout pipeline_layout,
@@ -446,6 +530,19 @@ inline VkPipeline create_graphics_pipeline(VkDevice device, VkRenderPass render_
                                     fragment_shader, nullptr, 0, nullptr, 0);
 }
 
+VkPipeline create_compute_pipeline(VkDevice device, VkPipelineCache pipeline_cache,
+                                   VkPipelineLayout pipeline_layout,
+                                   VkShaderModule compute_shader,
+                                   const VkSpecializationInfo* specialization_info);
+
+inline VkPipeline create_compute_pipeline(
+        VkDevice device, VkPipelineLayout pipeline_layout,
+        VkShaderModule compute_shader,
+        const VkSpecializationInfo* specialization_info = nullptr) {
+    return create_compute_pipeline(device, VK_NULL_HANDLE, pipeline_layout,
+                                   compute_shader, specialization_info);
+}
+
 VkSemaphore create_semaphore(VkDevice device);
 
 std::vector<VkSemaphore> create_semaphores(VkDevice device, size_t size);
@@ -509,26 +606,151 @@ void begin_command(VkCommandBuffer command_buffer, VkCommandBufferUsageFlags fla
 
 void end_command(VkCommandBuffer command_buffer);
 
+// VK_IMAGE_LAYOUT_GENERAL is treated as a storage image that is read and written by
+// compute shaders.
 void transition_layout(VkCommandBuffer command_buffer, VkImage image,
-                       VkImageLayout old_layout, VkImageLayout new_layout);
+                       VkImageLayout old_layout, VkImageLayout new_layout,
+                       const VkImageSubresourceRange& subresource_range);
+
+// Transitions only the first mip level and array layer.
+inline void transition_layout(VkCommandBuffer command_buffer, VkImage image,
+                              VkImageLayout old_layout, VkImageLayout new_layout) {
+    transition_layout(command_buffer, image, old_layout, new_layout,
+                      {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1});
+}
+
+// Transitions every mip level and array layer.
+inline void transition_layout_all(VkCommandBuffer command_buffer, VkImage image,
+                                  VkImageLayout old_layout,
+                                  VkImageLayout new_layout) {
+    transition_layout(command_buffer, image, old_layout, new_layout,
+                      {VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0,
+                       VK_REMAINING_ARRAY_LAYERS});
+}
+
+bool is_linear_blit_supported(VkPhysicalDevice physical_device, VkFormat format);
+
+// Fills every mip level after the first by blitting each level from the one before
+// it. Every level must be in VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL with the first one
+// already written, and all of them are left in the final layout, made visible to the
+// destination stage and access, e.g. the shader stages that sample the image. Linear
+// filtering requires is_linear_blit_supported() for the format.
+void generate_mipmaps(VkCommandBuffer command_buffer, VkImage image,
+                      const VkExtent2D& extent, uint32_t mip_levels,
+                      uint32_t array_layers = 1, VkFilter filter = VK_FILTER_LINEAR,
+                      VkImageLayout final_layout =
+                              VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                      VkPipelineStageFlags destination_stage =
+                              VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                      VkAccessFlags destination_access = VK_ACCESS_SHADER_READ_BIT);
+
+void memory_barrier(VkCommandBuffer command_buffer, VkPipelineStageFlags source_stage,
+                    VkAccessFlags source_access, VkPipelineStageFlags destination_stage,
+                    VkAccessFlags destination_access);
+
+void buffer_memory_barrier(VkCommandBuffer command_buffer, VkBuffer buffer,
+                           VkDeviceSize offset, VkDeviceSize size,
+                           VkPipelineStageFlags source_stage,
+                           VkAccessFlags source_access,
+                           VkPipelineStageFlags destination_stage,
+                           VkAccessFlags destination_access);
+
+inline void buffer_memory_barrier(VkCommandBuffer command_buffer, VkBuffer buffer,
+                                  VkPipelineStageFlags source_stage,
+                                  VkAccessFlags source_access,
+                                  VkPipelineStageFlags destination_stage,
+                                  VkAccessFlags destination_access) {
+    buffer_memory_barrier(command_buffer, buffer, 0, VK_WHOLE_SIZE, source_stage,
+                          source_access, destination_stage, destination_access);
+}
+
+// Transfers ownership of an exclusive image between queue families, optionally
+// changing its layout. The same barrier is recorded twice: on the source queue to
+// release the image, with a destination stage of BOTTOM_OF_PIPE and no destination
+// access, and then on the destination queue to acquire it, with a source stage of
+// TOP_OF_PIPE and no source access.
+void image_ownership_barrier(VkCommandBuffer command_buffer, VkImage image,
+                             VkImageLayout old_layout, VkImageLayout new_layout,
+                             uint32_t source_queue_family_index,
+                             uint32_t destination_queue_family_index,
+                             VkPipelineStageFlags source_stage,
+                             VkAccessFlags source_access,
+                             VkPipelineStageFlags destination_stage,
+                             VkAccessFlags destination_access);
+
+// A layout transition of every mip level and array layer with explicit stages and
+// accesses, for when transition_layout() does not wait on enough, e.g. shader reads
+// from a previous frame.
+inline void image_memory_barrier(VkCommandBuffer command_buffer, VkImage image,
+                                 VkImageLayout old_layout, VkImageLayout new_layout,
+                                 VkPipelineStageFlags source_stage,
+                                 VkAccessFlags source_access,
+                                 VkPipelineStageFlags destination_stage,
+                                 VkAccessFlags destination_access) {
+    image_ownership_barrier(command_buffer, image, old_layout, new_layout,
+                            VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+                            source_stage, source_access, destination_stage,
+                            destination_access);
+}
+
+// Bytes per texel of common uncompressed color formats, and 0 for anything else.
+uint32_t get_texel_size(VkFormat format) noexcept;
+
+// Requirement: image layout must be VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL. The pixels
+// are read tightly packed from the given buffer offset.
+void copy_buffer_to_image(VkCommandBuffer command_buffer, VkBuffer buffer,
+                          VkImage image, uint32_t width, uint32_t height,
+                          VkDeviceSize buffer_offset = 0);
 
-// Requirement: image layout must be VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL.
+// Copies several regions at once, e.g. the dirty rectangles laid out by
+// pack_image_regions(). Requirement: image layout must be
+// VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL.
 void copy_buffer_to_image(VkCommandBuffer command_buffer, VkBuffer buffer,
-                          VkImage image, uint32_t width, uint32_t height);
+                          VkImage image,
+                          const std::vector<VkBufferImageCopy>& regions);
+
+// Clips dirty rectangles to the extent and drops the empty ones. Rectangles that
+// overlap are replaced by their bounding box, since the regions of a copy must not
+// overlap, and ones that line up with each other, such as consecutive scanlines, are
+// joined. This compares every pair, so more than 64 rectangles are replaced by their
+// bounding box instead.
+void merge_dirty_rects(std::vector<VkRect2D>& rects, const VkExtent2D& extent);
+
+// Lays the rectangles out one after another from the buffer offset, each with tightly
+// packed rows and starting at an offset that copies allow. The regions are replaced,
+// and the offset past the last one is returned.
+VkDeviceSize pack_image_regions(const std::vector<VkRect2D>& rects, uint32_t texel_size,
+                                VkDeviceSize buffer_offset,
+                                std::vector<VkBufferImageCopy>& regions);
 
 // Requirements: Image layout must be VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL.
 void copy_image_to_buffer(VkCommandBuffer command_buffer, VkImage image, uint32_t width,
                           uint32_t height, VkBuffer buffer);
 
-VkImageView create_image_view(
+VkImageView create_image_view(VkDevice device, VkImage image, VkFormat format,
+                              const VkImageSubresourceRange& subresource_range,
+                              VkImageViewType image_view_type = VK_IMAGE_VIEW_TYPE_2D);
+
+// Views only the first mip level and array layer.
+inline VkImageView create_image_view(
         VkDevice device, VkImage image, VkFormat format,
         VkImageAspectFlags aspect_mask = VK_IMAGE_ASPECT_COLOR_BIT,
-        VkImageViewType image_view_type = VK_IMAGE_VIEW_TYPE_2D);
+        VkImageViewType image_view_type = VK_IMAGE_VIEW_TYPE_2D) {
+    return create_image_view(device, image, format, {aspect_mask, 0, 1, 0, 1},
+                             image_view_type);
+}
 
 VkSampler create_sampler(VkDevice device, VkFilter mag_filter, VkFilter min_filter,
                          VkSamplerAddressMode mode_u, VkSamplerAddressMode mode_v,
                          VkSamplerAddressMode mode_w);
 
+// Samples mip levels up to max_lod, which is every level for VK_LOD_CLAMP_NONE. The
+// other overloads only ever sample the first level.
+VkSampler create_sampler(VkDevice device, VkFilter mag_filter, VkFilter min_filter,
+                         VkSamplerMipmapMode mipmap_mode,
+                         VkSamplerAddressMode address_mode,
+                         float max_lod = VK_LOD_CLAMP_NONE);
+
 inline VkSampler create_sampler(
         VkDevice device, VkFilter mag_filter, VkFilter min_filter,
         VkSamplerAddressMode address_mode = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER) {